@@ -12,6 +12,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #ifndef OOMPH_BENCHMARKS_PURE_MPI
 #include <oomph/utils.hpp>
@@ -23,18 +25,64 @@
 
 namespace oomph
 {
+/** @brief command line arguments of the benchmarks
+  *
+  * Positional arguments are [niter] [msg_size] [inflight]. The message size may also be given as
+  * a logarithmic sweep min:max[:factor] (factor defaults to 2). Options, placed anywhere:
+  *   -t secs   time-bounded run: the iteration count of every message size is calibrated from
+  *             the warmup run to take about secs seconds (niter, if non-zero, is an upper bound)
+  *   -w n      warmup iterations before every message size (default 1000 with -t, else 0); -t
+  *             needs at least one warmup iteration to calibrate from
+  *   -o fmt    machine-readable output: csv (default) or json */
 struct args
 {
-    bool is_valid = true;
-    int  n_iter = 0;
-    int  n_secs = 5;
-    int  buff_size = 0;
-    int  inflight = 0;
-    int  num_threads = 1;
+    enum class output_format
+    {
+        csv,
+        json
+    };
+
+    bool             is_valid = true;
+    int              n_iter = 0;
+    int              n_secs = 5;
+    int              buff_size = 0;
+    int              inflight = 0;
+    int              num_threads = 1;
+    bool             timed = false;
+    int              n_warmup = 0;
+    std::vector<int> sizes;
+    output_format    format = output_format::csv;
 
-    args(int argc, char** argv, bool timed = false)
+    args(int argc, char** argv, bool timed_ = false)
+    : timed{timed_}
     {
-        if (argc != 4)
+        std::vector<char const*> pos;
+        bool                     warmup_set = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            bool const has_value = (i + 1 < argc);
+            if (!std::strcmp(argv[i], "-t") && has_value)
+            {
+                timed = true;
+                n_secs = std::atoi(argv[++i]);
+            }
+            else if (!std::strcmp(argv[i], "-w") && has_value)
+            {
+                warmup_set = true;
+                n_warmup = std::atoi(argv[++i]);
+            }
+            else if (!std::strcmp(argv[i], "-o") && has_value)
+            {
+                std::string const fmt = argv[++i];
+                if (fmt == "json") format = output_format::json;
+                else if (fmt != "csv")
+                    is_valid = false;
+            }
+            else
+                pos.push_back(argv[i]);
+        }
+
+        if (pos.size() != 3)
         {
             is_valid = false;
 #ifndef OOMPH_BENCHMARKS_PURE_MPI
@@ -43,14 +91,16 @@ struct args
         }
         else
         {
-            if (timed) {
-                n_secs = std::atoi(argv[1]);
-            }
-            else {
-                n_iter = std::atoi(argv[1]);
-            }
-            buff_size = std::atoi(argv[2]);
-            inflight = std::atoi(argv[3]);
+            if (timed_) { n_secs = std::atoi(pos[0]); }
+            else { n_iter = std::atoi(pos[0]); }
+            parse_sizes(pos[1]);
+            inflight = std::atoi(pos[2]);
+            if (timed && !timed_ && !warmup_set) n_warmup = 1000;
+            if (sizes.empty() || n_secs <= 0 || inflight <= 0) is_valid = false;
+            else if (timed && !timed_ && n_warmup <= 0)
+                is_valid = false;
+            else
+                buff_size = sizes.front();
 
 #ifdef OOMPH_BENCHMARKS_MT
 #pragma omp parallel
@@ -63,6 +113,22 @@ struct args
     }
 
     operator bool() const noexcept { return is_valid; }
+
+  private:
+    void parse_sizes(char const* arg)
+    {
+        char*      end;
+        long const first = std::strtol(arg, &end, 10);
+        long       last = first;
+        long       factor = 2;
+        if (*end == ':')
+        {
+            last = std::strtol(end + 1, &end, 10);
+            if (*end == ':') factor = std::strtol(end + 1, &end, 10);
+        }
+        if (*end != '\0' || first < 0 || last < first || factor < 2) return;
+        for (long s = first; s <= last; s = (s > 0 ? s * factor : 1)) sizes.push_back((int)s);
+    }
 };
 
 } // namespace oomph
@@ -0,0 +1,164 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include "./mpi_environment.hpp"
+#include "./args.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Offline tuning of the protocol thresholds, written to a profile which later runs pick up through
+// OOMPH_PROFILE. For every threshold which the backend lets the context change, every message size
+// of the sweep (and 0, the default of the transport, where it applies) is tried as a candidate: a
+// context is created with the threshold set, and niter bidirectional exchanges of inflight
+// messages are timed for every size of the sweep. The candidate whose times, relative to the best
+// candidate of each size, have the smallest sum is written to the file named by OOMPH_PROFILE
+// (default: oomph_profile.txt). Runs with 2 ranks, e.g.
+//   OOMPH_PROFILE=ucx.profile mpirun -np 2 bench_autotune_ucx 100 1024:4194304:4 8
+
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
+struct knob
+{
+    const char* name;
+    // 0 leaves the choice to the transport
+    bool has_default;
+};
+
+// the thresholds which the backend of ctxt lets a context change
+std::vector<knob>
+knobs(context& ctxt)
+{
+    std::string const name = ctxt.get_transport_option("name");
+    if (name == "ucx") return {{"OOMPH_RNDV_THRESHOLD", true}};
+    if (name == "libfabric") return {{"OOMPH_INJECT_THRESHOLD", true}};
+    return {};
+}
+
+// niter exchanges of inflight messages of buff_size bytes with the peer, returns the largest
+// elapsed time of both ranks [us]
+double
+run(context& ctxt, int buff_size, long niter, int inflight)
+{
+    auto       comm = ctxt.get_communicator();
+    auto const peer_rank = (comm.rank() + 1) % 2;
+
+    std::vector<message> smsgs(inflight);
+    std::vector<message> rmsgs(inflight);
+    for (int j = 0; j < inflight; j++)
+    {
+        smsgs[j] = comm.make_buffer<char>(buff_size);
+        rmsgs[j] = comm.make_buffer<char>(buff_size);
+        for (auto& c : smsgs[j]) c = 0;
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    timer t;
+    for (long i = 0; i < niter; ++i)
+    {
+        for (int j = 0; j < inflight; j++)
+        {
+            comm.recv(rmsgs[j], peer_rank, j);
+            comm.send(smsgs[j], peer_rank, j);
+        }
+        comm.wait_all();
+    }
+    double elapsed = t.stoc();
+    MPI_Allreduce(MPI_IN_PLACE, &elapsed, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    auto const        file_name = std::getenv("OOMPH_PROFILE");
+    std::string const profile = file_name ? file_name : "oomph_profile.txt";
+    auto const&       sizes = cmd_args.sizes;
+
+    std::vector<std::string> lines;
+    std::vector<knob>        tuned;
+    {
+        context ctxt(MPI_COMM_WORLD, multi_threaded);
+        tuned = knobs(ctxt);
+        lines.push_back(std::string("# ") + ctxt.get_transport_option("name") +
+                        ", written by bench_autotune");
+    }
+
+    for (auto const& k : tuned)
+    {
+        std::vector<long> candidates;
+        if (k.has_default) candidates.push_back(0);
+        for (auto s : sizes) candidates.push_back(s);
+
+        // times[c][s]
+        std::vector<std::vector<double>> times;
+        for (auto c : candidates)
+        {
+            setenv(k.name, std::to_string(c).c_str(), 1);
+            context ctxt(MPI_COMM_WORLD, multi_threaded);
+            unsetenv(k.name);
+            times.emplace_back();
+            for (auto s : sizes)
+            {
+                if (cmd_args.n_warmup > 0) run(ctxt, s, cmd_args.n_warmup, cmd_args.inflight);
+                times.back().push_back(run(ctxt, s, cmd_args.n_iter, cmd_args.inflight));
+                if (env.rank == 0)
+                    std::cout << k.name << "=" << c << " size " << s << ": "
+                              << times.back().back() / cmd_args.n_iter << " us\n";
+            }
+            // contexts on the same communicator are created one after another
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+
+        // sum of the times relative to the best candidate of each size, the first candidate wins
+        // ties
+        std::size_t best = 0;
+        double      best_score = 0;
+        for (std::size_t c = 0; c < candidates.size(); ++c)
+        {
+            double score = 0;
+            for (std::size_t s = 0; s < sizes.size(); ++s)
+            {
+                double t_min = times[0][s];
+                for (auto const& t : times) t_min = std::min(t_min, t[s]);
+                score += times[c][s] / std::max(t_min, 1.0);
+            }
+            if (c == 0 || score < best_score)
+            {
+                best = c;
+                best_score = score;
+            }
+        }
+        lines.push_back(std::string(k.name) + "=" + std::to_string(candidates[best]));
+    }
+
+    if (env.rank == 0)
+    {
+        std::ofstream file(profile);
+        for (auto const& l : lines) file << l << "\n";
+        if (tuned.empty()) std::cout << "no threshold to tune for this backend\n";
+        std::cout << "profile written to " << profile << ":\n";
+        for (auto const& l : lines) std::cout << l << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include <cstdlib>
+#include <iostream>
+#ifdef OOMPH_BENCHMARKS_MT
+#include <omp.h>
+#endif
+
+// Thread scaling of the barrier: for 1, 2, 4, ... up to the number of OpenMP threads, measure the
+// time per thread barrier and per full (threads and ranks) barrier. Runs with any number of ranks.
+
+int
+main(int argc, char** argv)
+{
+    using namespace oomph;
+
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " [niter]" << std::endl;
+        return 1;
+    }
+    const int niter = std::atoi(argv[1]);
+
+#ifdef OOMPH_BENCHMARKS_MT
+    const int max_threads = omp_get_max_threads();
+#else
+    const int max_threads = 1;
+#endif
+    bool const multi_threaded = (max_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    context         ctxt(MPI_COMM_WORLD, multi_threaded);
+
+    if (env.rank == 0)
+    {
+        std::cout << "\n\nrunning test " << __FILE__ << "\n\n";
+        std::cout << "N         = " << niter << std::endl;
+        std::cout << "ranks     = " << env.size << std::endl;
+    }
+
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+    {
+        // construction is collective over the ranks
+        barrier b(ctxt, num_threads);
+        timer   t_thread;
+        timer   t_full;
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel num_threads(num_threads)
+#endif
+        {
+            const auto thread_id = THREADID;
+            auto       comm = ctxt.get_communicator();
+
+            b();
+            if (thread_id == 0) t_thread.tic();
+            for (int i = 0; i < niter; ++i) b.thread_barrier();
+            if (thread_id == 0) t_thread.toc();
+
+            b();
+            if (thread_id == 0) t_full.tic();
+            for (int i = 0; i < niter; ++i) b();
+            if (thread_id == 0) t_full.toc();
+        }
+
+        auto const thread_us = t_thread.mean() / niter;
+        auto const full_us = t_full.mean() / niter;
+        if (env.rank == 0)
+        {
+            // clang-format off
+            std::cout << "threads: " << num_threads
+                      << ", thread barrier us: " << thread_us
+                      << ", full barrier us: " << full_us << "\n";
+            std::cout << "CSVData"
+                      << ", niter, " << niter
+                      << ", num_ranks, " << env.size
+                      << ", num_threads, " << num_threads
+                      << ", transport, " << ctxt.get_transport_option("name")
+                      << ", thread_barrier us, " << thread_us
+                      << ", full_barrier us, " << full_us
+                      << "\n";
+            // clang-format on
+        }
+    }
+
+    return 0;
+}
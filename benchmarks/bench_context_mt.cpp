@@ -0,0 +1,63 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include "./mpi_environment.hpp"
+#include "./timer.hpp"
+#include <cstdlib>
+#include <iostream>
+
+// Context creation time on MPI_COMM_WORLD, which includes the exchange of the transport addresses
+// of all ranks. The first creation is reported separately: the libfabric backend sets up its
+// endpoints and exchanges the addresses only once per process (with LIBFABRIC_LAZY_AV=1 the peers
+// are inserted into the address vector on first contact instead). Reports the largest time over
+// all ranks; run with several rank counts to see the scaling, e.g.
+//   for n in 2 4 8 16; do mpirun -np $n bench_context_libfabric 10; done
+
+using namespace oomph;
+
+// creates a context, returns the largest time over all ranks [us]
+double
+create(bool thread_safe)
+{
+    MPI_Barrier(MPI_COMM_WORLD);
+    timer  t;
+    double elapsed;
+    {
+        context ctxt(MPI_COMM_WORLD, thread_safe);
+        elapsed = t.stoc();
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &elapsed, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    int const niter = (argc > 1) ? std::atoi(argv[1]) : 10;
+    if (argc > 2 || niter < 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [niter]" << std::endl;
+        return 1;
+    }
+
+    mpi_environment env(false, argc, argv);
+
+    double const first = create(false);
+    double       total = 0;
+    for (int i = 0; i < niter; ++i) total += create(false);
+
+    if (env.rank == 0)
+    {
+        std::cout << "ranks,first_us,mean_us\n";
+        std::cout << env.size << "," << first << "," << total / niter << std::endl;
+    }
+
+    return 0;
+}
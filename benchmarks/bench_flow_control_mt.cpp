@@ -0,0 +1,164 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./args.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include "./report.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Unexpected message stress: rank 0 posts all niter sends (of every thread) at once, and rank 1
+// only starts to receive them, inflight at a time, after all sends have been posted. Without flow
+// control the messages pile up in the unexpected queue of the receiver, and its memory grows with
+// niter; with OOMPH_FLOW_CREDITS=<n> at most n messages per thread are in flight, and the sender
+// holds the rest back. The peak resident set size of both ranks is reported with the rate.
+// Runs with 2 ranks.
+
+const char* syncmode = "callback";
+const char* waitmode = "avail";
+
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
+// peak resident set size of this process [kB]
+long
+max_rss()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// every thread of rank 0 sends niter messages of buff_size bytes to rank 1, returns the elapsed
+// time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, int buff_size, long niter, bool verbose,
+    std::vector<thread_stats>& stats)
+{
+    timer  t0;
+    double elapsed = 0;
+
+    const auto inflight = cmd_args.inflight;
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+#endif
+    {
+        // one tag range per thread: the threads do not match each other's messages
+        const auto thread_id = THREADID;
+        auto       comm = ctxt.get_communicator(thread_id);
+        const auto rank = comm.rank();
+        const auto tag = 0;
+
+        if (verbose && thread_id == 0 && rank == 0)
+        { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
+
+        // the sends share one buffer
+        message              smsg = comm.make_buffer<char>(buff_size);
+        std::vector<message> rmsgs(inflight);
+        for (auto& c : smsg) c = 0;
+        for (int j = 0; j < inflight; j++) rmsgs[j] = comm.make_buffer<char>(buff_size);
+
+        long sent = 0;
+        long received = 0;
+        auto send_callback = [&sent](message const&, rank_type, tag_type) { ++sent; };
+        auto recv_callback = [&received](message&, rank_type, tag_type) { ++received; };
+
+        b();
+
+        timer tt;
+        if (thread_id == 0) t0.tic();
+
+        if (rank == 0)
+            for (long i = 0; i < niter; ++i) comm.send(smsg, 1, tag, send_callback);
+
+        // the receiver starts late
+        b();
+
+        if (rank == 0)
+            while (sent < niter) comm.progress();
+        else
+        {
+            for (long i = 0; i < niter; i += inflight)
+            {
+                auto const n = std::min<long>(inflight, niter - i);
+                received = 0;
+                for (long j = 0; j < n; j++) comm.recv(rmsgs[j], 0, tag, recv_callback);
+                while (received < n) comm.progress();
+            }
+        }
+
+        stats[thread_id].messages = niter;
+        stats[thread_id].time = tt.stoc();
+
+        b();
+
+        if (thread_id == 0) elapsed = t0.stoc();
+    }
+
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    const auto inflight = cmd_args.inflight;
+    const auto num_threads = cmd_args.num_threads;
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded, num_threads);
+    barrier b(ctxt, num_threads);
+    report  rep(ctxt, cmd_args, syncmode, waitmode);
+    auto const credits = std::getenv("OOMPH_FLOW_CREDITS");
+    rep.set("credits", credits ? credits : "0");
+
+    for (auto buff_size : cmd_args.sizes)
+    {
+        const auto niter = rep.iterations([&](long n)
+            { return run(ctxt, b, cmd_args, buff_size, n, false, rep.threads()); });
+
+        if (env.rank == 0)
+        {
+            std::cout << "credits  = " << (credits ? credits : "0") << std::endl;
+            std::cout << "inflight = " << inflight << std::endl;
+            std::cout << "size     = " << buff_size << std::endl;
+            std::cout << "N        = " << niter << std::endl;
+        }
+
+        const auto t = run(ctxt, b, cmd_args, buff_size, niter, true, rep.threads());
+
+        // peak memory of the sender and the receiver (monotonic over the message sizes)
+        std::vector<long> rss(2);
+        long const        local_rss = max_rss();
+        MPI_Gather(&local_rss, 1, MPI_LONG, rss.data(), 1, MPI_LONG, 0, MPI_COMM_WORLD);
+        rep.record("send_rss_kb", std::to_string(rss[0]))
+            .record("recv_rss_kb", std::to_string(rss[1]));
+        if (env.rank == 0)
+            std::cout << "max rss kB [send,recv]: " << rss[0] << " " << rss[1] << "\n";
+
+        // messages sent by all threads
+        const auto n_msgs = (double)niter * num_threads;
+        rep(buff_size, niter, t, n_msgs * buff_size, n_msgs);
+    }
+
+    return 0;
+}
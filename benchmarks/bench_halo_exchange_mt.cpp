@@ -0,0 +1,256 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+#ifdef OOMPH_BENCHMARKS_MT
+#include <omp.h>
+#endif
+
+// Halo exchange on a periodic Cartesian decomposition of any number of ranks: every rank (and
+// every thread, which owns a sub-domain of its own) exchanges the faces, edges and corners of a
+// local domain of extent^dims doubles with halo width halo, i.e. it talks to 8 (2D) or 26 (3D)
+// neighbors. Mode "p2p" uses one recv/send per neighbor. Mode "multi" posts all receives with
+// recv_multi and sends each group of equally shaped halos (e.g. the two x-faces) with a single
+// send_multi, so all halos of a group share one buffer.
+
+const char* syncmode = "future";
+const char* waitmode = "wait";
+
+namespace
+{
+struct neighbor
+{
+    int              dir;   // base-3 encoded offset, the opposite direction is 26 - dir
+    unsigned int     shape; // bit mask of the axes with a non-zero offset
+    std::size_t      count; // number of doubles in the halo
+    oomph::rank_type dst;   // rank in direction dir
+    oomph::rank_type src;   // rank in the opposite direction
+};
+
+std::vector<neighbor>
+make_neighbors(MPI_Comm cart, int ndims, int extent, int halo)
+{
+    int coords[3] = {0, 0, 0};
+    int rank;
+    MPI_Comm_rank(cart, &rank);
+    MPI_Cart_coords(cart, rank, ndims, coords);
+
+    std::vector<neighbor> neighs;
+    for (int dir = 0; dir < 27; ++dir)
+    {
+        int const off[3] = {dir % 3 - 1, (dir / 3) % 3 - 1, dir / 9 - 1};
+        if (ndims == 2 && off[2] != 0) continue;
+        if (off[0] == 0 && off[1] == 0 && off[2] == 0) continue;
+        neighbor n{dir, 0u, 1u, 0, 0};
+        int      c_dst[3], c_src[3];
+        for (int d = 0; d < ndims; ++d)
+        {
+            if (off[d] != 0) n.shape |= (1u << d);
+            n.count *= (off[d] != 0 ? halo : extent);
+            c_dst[d] = coords[d] + off[d];
+            c_src[d] = coords[d] - off[d];
+        }
+        MPI_Cart_rank(cart, c_dst, &n.dst);
+        MPI_Cart_rank(cart, c_src, &n.src);
+        neighs.push_back(n);
+    }
+    return neighs;
+}
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    using namespace oomph;
+    using message = oomph::message_buffer<double>;
+
+    if (argc != 5)
+    {
+        std::cerr << "Usage: " << argv[0] << " [niter] [extent] [halo] [dims]" << std::endl;
+        std::cerr << "       dims is 2 or 3, runs with any number of MPI processes" << std::endl;
+        return 1;
+    }
+    const int niter = std::atoi(argv[1]);
+    const int extent = std::atoi(argv[2]);
+    const int halo = std::atoi(argv[3]);
+    const int ndims = std::atoi(argv[4]);
+    if (niter <= 0 || extent <= 0 || halo <= 0 || halo > extent || (ndims != 2 && ndims != 3))
+    {
+        std::cerr << "invalid arguments" << std::endl;
+        return 1;
+    }
+
+    int num_threads = 1;
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+    {
+#pragma omp master
+        num_threads = omp_get_num_threads();
+    }
+#endif
+    bool const multi_threaded = (num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+
+    // keep the rank order of MPI_COMM_WORLD, the context is built on it
+    int      dims[3] = {0, 0, 0};
+    int      periods[3] = {1, 1, 1};
+    MPI_Comm cart;
+    MPI_Dims_create(env.size, ndims, dims);
+    MPI_Cart_create(MPI_COMM_WORLD, ndims, dims, periods, 0, &cart);
+    auto const neighs = make_neighbors(cart, ndims, extent, halo);
+    MPI_Comm_free(&cart);
+
+    std::size_t step_bytes = 0;
+    for (auto const& n : neighs) step_bytes += n.count * sizeof(double);
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier b(ctxt, num_threads);
+
+    if (env.rank == 0)
+    {
+        std::cout << "\n\nrunning test " << __FILE__ << "\n\n";
+        std::cout << "grid      = " << dims[0] << "x" << dims[1];
+        if (ndims == 3) std::cout << "x" << dims[2];
+        std::cout << std::endl;
+        std::cout << "extent    = " << extent << std::endl;
+        std::cout << "halo      = " << halo << std::endl;
+        std::cout << "neighbors = " << neighs.size() << std::endl;
+        std::cout << "N         = " << niter << std::endl;
+        std::cout << "threads   = " << num_threads << std::endl;
+    }
+
+    for (const char* mode : {"p2p", "multi"})
+    {
+        bool const multi = (mode[0] == 'm');
+        timer      steps;      // per-step times of all threads of this rank
+        double     t_rank = 0; // total time of the slowest thread of this rank
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+#endif
+        {
+            auto       comm = ctxt.get_communicator();
+            const auto thread_id = THREADID;
+            const auto tag_offset = thread_id * 27;
+
+            std::vector<message>   smsgs;
+            std::vector<message>   rmsgs;
+            std::vector<rank_type> srcs;
+            std::vector<tag_type>  rtags;
+            for (auto const& n : neighs)
+            {
+                smsgs.push_back(comm.make_buffer<double>(n.count));
+                rmsgs.push_back(comm.make_buffer<double>(n.count));
+                for (auto& x : smsgs.back()) x = thread_id;
+                srcs.push_back(n.src);
+                rtags.push_back(tag_offset + n.dir);
+            }
+
+            // groups of equally shaped halos for send_multi: buffer index, destinations, tags
+            struct group
+            {
+                std::size_t            msg;
+                std::vector<rank_type> dsts;
+                std::vector<tag_type>  tags;
+            };
+            std::map<unsigned int, group> groups;
+            for (std::size_t i = 0; i < neighs.size(); ++i)
+            {
+                auto& g = groups.emplace(neighs[i].shape, group{i, {}, {}}).first->second;
+                g.dsts.push_back(neighs[i].dst);
+                g.tags.push_back(tag_offset + neighs[i].dir);
+            }
+
+            std::vector<recv_request>       rreqs(neighs.size());
+            std::vector<send_request>       sreqs(neighs.size());
+            std::vector<send_multi_request> mreqs;
+            timer                           tt;
+
+            b();
+
+            for (int step = 0; step < niter; ++step)
+            {
+                tt.tic();
+                if (multi)
+                {
+                    auto r = comm.recv_multi(rmsgs, srcs, rtags);
+                    mreqs.clear();
+                    for (auto const& g : groups)
+                        mreqs.push_back(
+                            comm.send_multi(smsgs[g.second.msg], g.second.dsts, g.second.tags));
+                    for (auto& s : mreqs) s.wait();
+                    r.wait();
+                }
+                else
+                {
+                    for (std::size_t i = 0; i < neighs.size(); ++i)
+                        rreqs[i] = comm.recv(rmsgs[i], srcs[i], rtags[i]);
+                    for (std::size_t i = 0; i < neighs.size(); ++i)
+                        sreqs[i] = comm.send(smsgs[i], neighs[i].dst, tag_offset + neighs[i].dir);
+                    comm.wait_all();
+                }
+                tt.toc();
+            }
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp critical
+#endif
+            {
+                steps(tt);
+                t_rank = std::max(t_rank, tt.sum());
+            }
+
+            b();
+        }
+
+        // load imbalance: slowest rank relative to the average rank
+        const auto all_steps = reduce(steps, MPI_COMM_WORLD);
+        double     t_max, t_sum;
+        MPI_Allreduce(&t_rank, &t_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce(&t_rank, &t_sum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        const double imbalance = t_max / (t_sum / env.size) - 1.0;
+        // bytes sent by all ranks and threads per microsecond of the slowest rank
+        const double bw = (double)step_bytes * niter * num_threads * env.size / t_max;
+
+        if (env.rank == 0)
+        {
+            // clang-format off
+            std::cout << mode << " us per step [min,mean,max]: [" << all_steps.min() << ","
+                      << all_steps.mean() << "," << all_steps.max() << "]\n";
+            std::cout << "CSVData"
+                      << ", niter, " << niter
+                      << ", num_ranks, " << env.size
+                      << ", num_threads, " << num_threads
+                      << ", dims, " << ndims
+                      << ", extent, " << extent
+                      << ", halo, " << halo
+                      << ", neighbors, " << neighs.size()
+                      << ", mode, " << mode
+                      << ", transport, " << ctxt.get_transport_option("name")
+                      << ", us per step, " << all_steps.mean()
+                      << ", max us per step, " << all_steps.max()
+                      << ", BW MB/s, " << bw
+                      << ", imbalance, " << imbalance
+                      << "\n";
+            // clang-format on
+        }
+    }
+
+    return 0;
+}
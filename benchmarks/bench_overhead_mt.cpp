@@ -0,0 +1,221 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./args.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include "./report.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Software overhead of the library per message: every rank (and thread) sends inflight messages
+// per iteration to itself, so that all of them are matched by the loopback queue and no transport
+// call is made. The API flavors are
+//   future       recv/send returning requests which are waited for
+//   cb_lref      recv/send with callbacks taking the message by reference
+//   cb_rref      recv/send with callbacks taking ownership of the message
+//   send_multi   one send_multi to inflight copies of self, receives as futures
+//   shared_recv  shared receives and sends returning requests
+// The loopback queue is enabled unless OOMPH_LOOPBACK=0 is set explicitly, which measures the
+// self path of the transport instead. Runs with any number of ranks.
+
+const char* waitmode = "wait";
+
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
+enum class flavor
+{
+    future,
+    cb_lref,
+    cb_rref,
+    send_multi,
+    shared_recv
+};
+
+// every thread sends niter messages of buff_size bytes to self, returns the elapsed time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, flavor f, int buff_size, long niter,
+    bool verbose, std::vector<thread_stats>& stats)
+{
+    timer  t0;
+    double elapsed = 0;
+
+    const auto inflight = cmd_args.inflight;
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+#endif
+    {
+        auto       comm = ctxt.get_communicator();
+        const auto rank = comm.rank();
+        const auto thread_id = THREADID;
+        const auto tag = thread_id;
+
+        if (verbose && thread_id == 0 && rank == 0)
+        { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
+
+        std::vector<message>             smsgs(inflight);
+        std::vector<message>             rmsgs(inflight);
+        std::vector<send_request>        sreqs(inflight);
+        std::vector<recv_request>        rreqs(inflight);
+        std::vector<shared_recv_request> srreqs(inflight);
+        std::vector<rank_type> const     self(inflight, rank);
+        for (int j = 0; j < inflight; j++)
+        {
+            smsgs[j] = comm.make_buffer<char>(buff_size);
+            rmsgs[j] = comm.make_buffer<char>(buff_size);
+            for (auto& c : smsgs[j]) c = 0;
+            for (auto& c : rmsgs[j]) c = 0;
+        }
+
+        int  sent = 0;
+        int  received = 0;
+        auto send_callback = [&sent](message&, rank_type, tag_type) { ++sent; };
+        auto recv_callback = [&received](message&, rank_type, tag_type) { ++received; };
+
+        b();
+
+        timer tt;
+        if (thread_id == 0) t0.tic();
+
+        for (long i = 0; i < niter; i += inflight)
+        {
+            switch (f)
+            {
+            case flavor::future:
+                for (int j = 0; j < inflight; j++) rreqs[j] = comm.recv(rmsgs[j], rank, tag);
+                for (int j = 0; j < inflight; j++) sreqs[j] = comm.send(smsgs[j], rank, tag);
+                for (int j = 0; j < inflight; j++)
+                {
+                    sreqs[j].wait();
+                    rreqs[j].wait();
+                }
+                break;
+            case flavor::cb_lref:
+                sent = received = 0;
+                for (int j = 0; j < inflight; j++) comm.recv(rmsgs[j], rank, tag, recv_callback);
+                for (int j = 0; j < inflight; j++) comm.send(smsgs[j], rank, tag, send_callback);
+                while (sent < inflight || received < inflight) comm.progress();
+                break;
+            case flavor::cb_rref:
+                sent = received = 0;
+                for (int j = 0; j < inflight; j++)
+                    comm.recv(std::move(rmsgs[j]), rank, tag,
+                        [&rmsgs, &received, j](message m, rank_type, tag_type)
+                        {
+                            rmsgs[j] = std::move(m);
+                            ++received;
+                        });
+                for (int j = 0; j < inflight; j++)
+                    comm.send(std::move(smsgs[j]), rank, tag,
+                        [&smsgs, &sent, j](message m, rank_type, tag_type)
+                        {
+                            smsgs[j] = std::move(m);
+                            ++sent;
+                        });
+                while (sent < inflight || received < inflight) comm.progress();
+                break;
+            case flavor::send_multi:
+            {
+                for (int j = 0; j < inflight; j++) rreqs[j] = comm.recv(rmsgs[j], rank, tag);
+                auto sreq = comm.send_multi(smsgs[0], self, tag);
+                sreq.wait();
+                for (int j = 0; j < inflight; j++) rreqs[j].wait();
+                break;
+            }
+            case flavor::shared_recv:
+                for (int j = 0; j < inflight; j++)
+                    srreqs[j] = comm.shared_recv(rmsgs[j], rank, tag);
+                for (int j = 0; j < inflight; j++) sreqs[j] = comm.send(smsgs[j], rank, tag);
+                for (int j = 0; j < inflight; j++)
+                {
+                    sreqs[j].wait();
+                    srreqs[j].wait();
+                }
+                break;
+            }
+            stats[thread_id].messages += inflight;
+        }
+
+        stats[thread_id].time = tt.stoc();
+
+        b();
+
+        if (thread_id == 0) elapsed = t0.stoc();
+    }
+
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+
+    const auto inflight = cmd_args.inflight;
+    const auto num_threads = cmd_args.num_threads;
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier b(ctxt, num_threads);
+
+    for (auto f : {flavor::future, flavor::cb_lref, flavor::cb_rref, flavor::send_multi,
+             flavor::shared_recv})
+    {
+        const char* syncmode = (f == flavor::future)       ? "future"
+                               : (f == flavor::cb_lref)    ? "cb_lref"
+                               : (f == flavor::cb_rref)    ? "cb_rref"
+                               : (f == flavor::send_multi) ? "send_multi"
+                                                           : "shared_recv";
+        report rep(ctxt, cmd_args, syncmode, waitmode);
+        auto const loopback = std::getenv("OOMPH_LOOPBACK");
+        rep.set("loopback", loopback ? loopback : "1");
+
+        for (auto buff_size : cmd_args.sizes)
+        {
+            const auto niter = rep.iterations([&](long n)
+                { return run(ctxt, b, cmd_args, f, buff_size, n, false, rep.threads()); });
+            for (auto& s : rep.threads()) s = thread_stats{};
+
+            if (env.rank == 0)
+            {
+                std::cout << "flavor   = " << syncmode << std::endl;
+                std::cout << "inflight = " << inflight << std::endl;
+                std::cout << "size     = " << buff_size << std::endl;
+                std::cout << "N        = " << niter << std::endl;
+            }
+
+            const auto t = run(ctxt, b, cmd_args, f, buff_size, niter, true, rep.threads());
+
+            // time per message (send and matching receive) of the slowest thread
+            double ns_per_msg = 0;
+            for (auto const& s : rep.threads())
+                if (s.messages > 0) ns_per_msg = std::max(ns_per_msg, 1000 * s.time / s.messages);
+            MPI_Allreduce(MPI_IN_PLACE, &ns_per_msg, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            rep.record("ns/msg", std::to_string(ns_per_msg));
+            if (env.rank == 0) std::cout << "ns/msg:      " << ns_per_msg << "\n";
+
+            // messages sent by all ranks and threads
+            const auto n_msgs =
+                (double)env.size * ((niter + inflight - 1) / inflight) * inflight * num_threads;
+            rep(buff_size, niter, t, n_msgs * buff_size, n_msgs);
+        }
+    }
+
+    return 0;
+}
@@ -13,47 +13,33 @@
 #include "./args.hpp"
 #include "./timer.hpp"
 #include "./utils.hpp"
+#include "./report.hpp"
 #include <vector>
 
 const char *syncmode = "callback";
 const char *waitmode = "wait";
 
-int
-main(int argc, char** argv)
-{
-    using namespace oomph;
-    using message = oomph::message_buffer<char>;
+using namespace oomph;
+using message = oomph::message_buffer<char>;
 
-    args cmd_args(argc, argv);
-    if (!cmd_args) return exit(argv[0]);
-    bool const multi_threaded = (cmd_args.num_threads > 1);
-
-    mpi_environment env(multi_threaded, argc, argv);
-    if (env.size != 2) return exit(argv[0]);
-
-    context ctxt(MPI_COMM_WORLD, multi_threaded);
-    barrier b(ctxt, cmd_args.num_threads);
-    timer   t0;
-    timer   t1;
+// send/recv niter messages of buff_size bytes in each direction, returns the elapsed time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, int buff_size, long niter, bool verbose,
+    std::vector<thread_stats>& stats)
+{
+    timer  t0;
+    timer  t1;
+    double elapsed = 0;
 
     const auto inflight = cmd_args.inflight;
     const auto num_threads = cmd_args.num_threads;
-    const auto buff_size = cmd_args.buff_size;
-    const auto niter = cmd_args.n_iter;
-
-    if (env.rank == 0)
-    {
-        std::cout << "inflight = " << inflight << std::endl;
-        std::cout << "size     = " << buff_size << std::endl;
-        std::cout << "N        = " << niter << std::endl;
-    }
 
 #ifdef OOMPH_BENCHMARKS_MT
-    std::atomic<int> sent(0);
-    std::atomic<int> received(0);
+    std::atomic<long> sent(0);
+    std::atomic<long> received(0);
 #else
-    int sent(0);
-    int received(0);
+    long sent(0);
+    long received(0);
 #endif
 
 #ifdef OOMPH_BENCHMARKS_MT
@@ -66,10 +52,10 @@ main(int argc, char** argv)
         const auto thread_id = THREADID;
         const auto peer_rank = (rank + 1) % size;
 
-        int       comm_cnt = 0, nlsend_cnt = 0, nlrecv_cnt = 0;
-        int       i = 0, dbg = 0;
-        int       last_i = 0;
-        const int delta_i = niter / 10;
+        long       comm_cnt = 0, nlsend_cnt = 0, nlrecv_cnt = 0;
+        long       i = 0, dbg = 0;
+        long       last_i = 0;
+        const long delta_i = niter / 10;
 
         auto send_callback = [inflight, &nlsend_cnt, &comm_cnt, &sent](
                                  message&, int, int tag) {
@@ -87,7 +73,7 @@ main(int argc, char** argv)
             received++;
         };
 
-        if (thread_id == 0 && rank == 0)
+        if (verbose && thread_id == 0 && rank == 0)
         { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
 
         std::vector<message>      smsgs(inflight);
@@ -104,9 +90,10 @@ main(int argc, char** argv)
 
         b();
 
+        timer tt;
         if (thread_id == 0)
         {
-            if (rank == 0) std::cout << "number of threads: " << num_threads << "\n";
+            if (verbose && rank == 0) std::cout << "number of threads: " << num_threads << "\n";
             t0.tic();
             t1.tic();
         }
@@ -120,7 +107,7 @@ main(int argc, char** argv)
 #pragma omp barrier
 #endif
 
-            if (thread_id == 0 && dbg >= delta_i)
+            if (verbose && thread_id == 0 && dbg >= delta_i)
             {
                 dbg = 0;
                 std::cout << rank << " total bwdt MB/s:      "
@@ -153,35 +140,19 @@ main(int argc, char** argv)
             received = 0;
         }
 
+        stats[thread_id].messages = comm_cnt;
+        stats[thread_id].time = tt.stoc();
+
         b();
 
-        if (thread_id == 0 && rank == 0)
-        {
-            const auto t = t1.stoc();
-            double bw = ((double)niter*size*buff_size)/t;
-            // clang-format off
-            std::cout << "time:                   " << t / 1000000 << "s\n";
-            std::cout << "final MB/s: " << bw << "\n";
-            std::cout << "CSVData"
-                      << ", niter, " << niter
-                      << ", buff_size, " << buff_size
-                      << ", inflight, " << inflight
-                      << ", num_threads, " << num_threads
-                      << ", syncmode, " << syncmode
-                      << ", waitmode, " << waitmode
-                      << ", transport, " << ctxt.get_transport_option("name")
-                      << ", BW MB/s, " << bw
-                      << ", progress, " << ctxt.get_transport_option("progress")
-                      << ", endpoint, " << ctxt.get_transport_option("endpoint")
-                      << "\n";
-            // clang-format on
-        }
+        if (thread_id == 0) elapsed = t1.stoc();
 
         b();
 
 #ifdef OOMPH_BENCHMARKS_MT
 #pragma omp critical
 #endif
+        if (verbose)
         {
             std::cout << "rank " << rank << " thread " << thread_id << " serviced " << comm_cnt
                       << ", non-local sends " << nlsend_cnt << " non-local recvs " << nlrecv_cnt
@@ -191,5 +162,40 @@ main(int argc, char** argv)
         // tail loops - not needed in wait benchmarks
     }
 
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier b(ctxt, cmd_args.num_threads);
+    report  rep(ctxt, cmd_args, syncmode, waitmode);
+    rep.set("progress", ctxt.get_transport_option("progress"))
+        .set("endpoint", ctxt.get_transport_option("endpoint"));
+
+    for (auto buff_size : cmd_args.sizes)
+    {
+        const auto niter = rep.iterations([&](long n)
+            { return run(ctxt, b, cmd_args, buff_size, n, false, rep.threads()); });
+
+        if (env.rank == 0)
+        {
+            std::cout << "inflight = " << cmd_args.inflight << std::endl;
+            std::cout << "size     = " << buff_size << std::endl;
+            std::cout << "N        = " << niter << std::endl;
+        }
+
+        const auto t = run(ctxt, b, cmd_args, buff_size, niter, true, rep.threads());
+        rep(buff_size, niter, t, (double)niter * env.size * buff_size, (double)niter * env.size);
+    }
+
     return 0;
 }
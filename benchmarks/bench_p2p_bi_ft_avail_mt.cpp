@@ -13,51 +13,37 @@
 #include "./args.hpp"
 #include "./timer.hpp"
 #include "./utils.hpp"
+#include "./report.hpp"
 #include <vector>
 
 const char *syncmode = "future";
 const char *waitmode = "avail";
 
-int
-main(int argc, char** argv)
-{
-    using namespace oomph;
-    using message = oomph::message_buffer<char>;
+using namespace oomph;
+using message = oomph::message_buffer<char>;
 
-    args cmd_args(argc, argv);
-    if (!cmd_args) return exit(argv[0]);
-    bool const multi_threaded = (cmd_args.num_threads > 1);
-
-    mpi_environment env(multi_threaded, argc, argv);
-    if (env.size != 2) return exit(argv[0]);
-
-    context ctxt(MPI_COMM_WORLD, multi_threaded);
-    barrier b(ctxt, cmd_args.num_threads);
-    timer   t0;
-    timer   t1;
+// send/recv niter messages of buff_size bytes in each direction, returns the elapsed time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, int buff_size, long niter, bool verbose,
+    std::vector<thread_stats>& stats)
+{
+    timer  t0;
+    timer  t1;
+    double elapsed = 0;
 
     const auto inflight = cmd_args.inflight;
     const auto num_threads = cmd_args.num_threads;
-    const auto buff_size = cmd_args.buff_size;
-    const auto niter = cmd_args.n_iter;
-
-    if (env.rank == 0)
-    {
-        std::cout << "inflight = " << inflight << std::endl;
-        std::cout << "size     = " << buff_size << std::endl;
-        std::cout << "N        = " << niter << std::endl;
-    }
 
 #ifdef OOMPH_BENCHMARKS_MT
-    std::atomic<int> sent(0);
-    std::atomic<int> received(0);
-    std::atomic<int> tail_send(0);
-    std::atomic<int> tail_recv(0);
+    std::atomic<long> sent(0);
+    std::atomic<long> received(0);
+    std::atomic<int>  tail_send(0);
+    std::atomic<int>  tail_recv(0);
 #else
-    int sent(0);
-    int received(0);
-    int tail_send(0);
-    int tail_recv(0);
+    long sent(0);
+    long received(0);
+    int  tail_send(0);
+    int  tail_recv(0);
 #endif
 
 #ifdef OOMPH_BENCHMARKS_MT
@@ -70,13 +56,13 @@ main(int argc, char** argv)
         const auto thread_id = THREADID;
         const auto peer_rank = (rank + 1) % size;
 
-        int       dbg = 0, sdbg = 0, rdbg = 0;
-        int       last_received = 0;
-        int       last_sent = 0;
-        int       lsent = 0, lrecv = 0;
-        const int delta_i = niter / 10;
+        long       dbg = 0, sdbg = 0, rdbg = 0;
+        long       last_received = 0;
+        long       last_sent = 0;
+        long       lsent = 0, lrecv = 0;
+        const long delta_i = niter / 10;
 
-        if (thread_id == 0 && rank == 0)
+        if (verbose && thread_id == 0 && rank == 0)
         { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
 
         std::vector<message>      smsgs(inflight);
@@ -93,9 +79,10 @@ main(int argc, char** argv)
 
         b();
 
+        timer tt;
         if (thread_id == 0)
         {
-            if (rank == 0) std::cout << "number of threads: " << num_threads << "\n";
+            if (verbose && rank == 0) std::cout << "number of threads: " << num_threads << "\n";
             t0.tic();
             t1.tic();
         }
@@ -111,19 +98,19 @@ main(int argc, char** argv)
         {
             for (int j = 0; j < inflight; j++)
             {
-                if (rank == 0 && thread_id == 0 && sdbg >= delta_i)
+                if (verbose && rank == 0 && thread_id == 0 && sdbg >= delta_i)
                 {
                     std::cout << sent << " sent\n";
                     sdbg = 0;
                 }
 
-                if (rank == 0 && thread_id == 0 && rdbg >= delta_i)
+                if (verbose && rank == 0 && thread_id == 0 && rdbg >= delta_i)
                 {
                     std::cout << received << " received\n";
                     rdbg = 0;
                 }
 
-                if (thread_id == 0 && dbg >= delta_i)
+                if (verbose && thread_id == 0 && dbg >= delta_i)
                 {
                     dbg = 0;
                     std::cout << rank << " total bwdt MB/s:      "
@@ -158,29 +145,12 @@ main(int argc, char** argv)
             }
         }
 
+        stats[thread_id].messages = lsent + lrecv;
+        stats[thread_id].time = tt.stoc();
+
         b();
 
-        if (thread_id == 0 && rank == 0)
-        {
-            const auto t = t1.stoc();
-            double bw = ((double)niter*size*buff_size)/t;
-            // clang-format off
-            std::cout << "time:                   " << t / 1000000 << "s\n";
-            std::cout << "final MB/s: " << bw << "\n";
-            std::cout << "CSVData"
-                      << ", niter, " << niter
-                      << ", buff_size, " << buff_size
-                      << ", inflight, " << inflight
-                      << ", num_threads, " << num_threads
-                      << ", syncmode, " << syncmode
-                      << ", waitmode, " << waitmode
-                      << ", transport, " << ctxt.get_transport_option("name")
-                      << ", BW MB/s, " << bw
-                      << ", progress, " << ctxt.get_transport_option("progress")
-                      << ", endpoint, " << ctxt.get_transport_option("endpoint")
-                      << "\n";
-            // clang-format on
-        }
+        if (thread_id == 0) elapsed = t1.stoc();
 
         b();
 
@@ -257,5 +227,40 @@ main(int argc, char** argv)
         for (int j = 0; j < inflight; j++) { rreqs[j].cancel(); }
     }
 
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier b(ctxt, cmd_args.num_threads);
+    report  rep(ctxt, cmd_args, syncmode, waitmode);
+    rep.set("progress", ctxt.get_transport_option("progress"))
+        .set("endpoint", ctxt.get_transport_option("endpoint"));
+
+    for (auto buff_size : cmd_args.sizes)
+    {
+        const auto niter = rep.iterations([&](long n)
+            { return run(ctxt, b, cmd_args, buff_size, n, false, rep.threads()); });
+
+        if (env.rank == 0)
+        {
+            std::cout << "inflight = " << cmd_args.inflight << std::endl;
+            std::cout << "size     = " << buff_size << std::endl;
+            std::cout << "N        = " << niter << std::endl;
+        }
+
+        const auto t = run(ctxt, b, cmd_args, buff_size, niter, true, rep.threads());
+        rep(buff_size, niter, t, (double)niter * env.size * buff_size, (double)niter * env.size);
+    }
+
     return 0;
 }
@@ -0,0 +1,151 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./args.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include "./histogram.hpp"
+#include "./report.hpp"
+#include <chrono>
+#include <vector>
+
+// Ping-pong latency: rank 0 sends inflight messages to rank 1 which sends them back. The round
+// trip time of every iteration is recorded into a histogram and reported as percentiles. Each
+// thread runs its own ping-pong on a distinct set of tags.
+
+const char* syncmode = "future";
+const char* waitmode = "wait";
+
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
+// niter round trips of buff_size bytes, returns the elapsed time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, int buff_size, long niter, bool verbose,
+    std::vector<thread_stats>& stats, histogram& lat)
+{
+    using clock_type = std::chrono::steady_clock;
+
+    timer  t0;
+    double elapsed = 0;
+
+    const auto inflight = cmd_args.inflight;
+    const auto num_threads = cmd_args.num_threads;
+
+    std::vector<histogram> lats(num_threads);
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+#endif
+    {
+        auto       comm = ctxt.get_communicator();
+        const auto rank = comm.rank();
+        const auto thread_id = THREADID;
+        const auto peer_rank = (rank + 1) % 2;
+        auto&      h = lats[thread_id];
+
+        if (verbose && thread_id == 0 && rank == 0)
+        { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
+
+        std::vector<message>      smsgs(inflight);
+        std::vector<message>      rmsgs(inflight);
+        std::vector<send_request> sreqs(inflight);
+        std::vector<recv_request> rreqs(inflight);
+        for (int j = 0; j < inflight; j++)
+        {
+            smsgs[j] = comm.make_buffer<char>(buff_size);
+            rmsgs[j] = comm.make_buffer<char>(buff_size);
+            for (auto& c : smsgs[j]) c = 0;
+            for (auto& c : rmsgs[j]) c = 0;
+        }
+
+        b();
+
+        timer tt;
+        if (thread_id == 0) t0.tic();
+
+        for (long i = 0; i < niter; ++i)
+        {
+            const auto start = clock_type::now();
+            if (rank == 0)
+            {
+                for (int j = 0; j < inflight; j++)
+                    rreqs[j] = comm.recv(rmsgs[j], peer_rank, thread_id * inflight + j);
+                for (int j = 0; j < inflight; j++)
+                    sreqs[j] = comm.send(smsgs[j], peer_rank, thread_id * inflight + j);
+                comm.wait_all();
+                h(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start)
+                        .count());
+            }
+            else
+            {
+                for (int j = 0; j < inflight; j++)
+                    rreqs[j] = comm.recv(rmsgs[j], peer_rank, thread_id * inflight + j);
+                for (int j = 0; j < inflight; j++)
+                {
+                    rreqs[j].wait();
+                    sreqs[j] = comm.send(smsgs[j], peer_rank, thread_id * inflight + j);
+                }
+                comm.wait_all();
+            }
+        }
+
+        stats[thread_id].messages = 2 * niter * inflight;
+        stats[thread_id].time = tt.stoc();
+
+        b();
+
+        if (thread_id == 0) elapsed = t0.stoc();
+    }
+
+    lat.clear();
+    for (auto const& h : lats) lat(h);
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    context   ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier   b(ctxt, cmd_args.num_threads);
+    report    rep(ctxt, cmd_args, syncmode, waitmode);
+    histogram lat;
+    rep.set("progress", ctxt.get_transport_option("progress"))
+        .set("endpoint", ctxt.get_transport_option("endpoint"));
+
+    for (auto buff_size : cmd_args.sizes)
+    {
+        const auto niter = rep.iterations([&](long n)
+            { return run(ctxt, b, cmd_args, buff_size, n, false, rep.threads(), lat); });
+
+        if (env.rank == 0)
+        {
+            std::cout << "inflight = " << cmd_args.inflight << std::endl;
+            std::cout << "size     = " << buff_size << std::endl;
+            std::cout << "N        = " << niter << std::endl;
+        }
+
+        const auto t = run(ctxt, b, cmd_args, buff_size, niter, true, rep.threads(), lat);
+        // round trips of all threads
+        const auto n_msgs = 2.0 * niter * cmd_args.inflight * cmd_args.num_threads;
+        rep(buff_size, niter, t, n_msgs * buff_size, n_msgs, &lat);
+    }
+
+    return 0;
+}
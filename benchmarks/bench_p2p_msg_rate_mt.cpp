@@ -0,0 +1,138 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./args.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include "./report.hpp"
+#include <vector>
+
+// Small-message rate with one communicator (and one tag range) per thread. Compare the matching
+// modes of the MPI backend by running with e.g.
+//   OOMPH_MPI_COMM_POOL_SIZE=0                 (default: all threads match on one communicator)
+//   OOMPH_MPI_COMM_POOL_SIZE=<num_threads>     (one duplicated communicator per thread)
+//   OOMPH_MPI_ASSERT_NO_ANY_SOURCE=1 OOMPH_MPI_ASSERT_NO_ANY_TAG=1 ... (additional hints)
+
+const char* syncmode = "future";
+const char* waitmode = "wait";
+
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
+// every thread exchanges niter messages of buff_size bytes with the peer, returns the elapsed
+// time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, int buff_size, long niter, bool verbose,
+    std::vector<thread_stats>& stats)
+{
+    timer  t0;
+    double elapsed = 0;
+
+    const auto inflight = cmd_args.inflight;
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+#endif
+    {
+        const auto thread_id = THREADID;
+        auto       comm = ctxt.get_communicator(thread_id);
+        const auto rank = comm.rank();
+        const auto peer_rank = (rank + 1) % 2;
+
+        if (verbose && thread_id == 0 && rank == 0)
+        { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
+
+        std::vector<message>      smsgs(inflight);
+        std::vector<message>      rmsgs(inflight);
+        std::vector<send_request> sreqs(inflight);
+        std::vector<recv_request> rreqs(inflight);
+        for (int j = 0; j < inflight; j++)
+        {
+            smsgs[j] = comm.make_buffer<char>(buff_size);
+            rmsgs[j] = comm.make_buffer<char>(buff_size);
+            for (auto& c : smsgs[j]) c = 0;
+            for (auto& c : rmsgs[j]) c = 0;
+        }
+
+        b();
+
+        timer tt;
+        if (thread_id == 0) t0.tic();
+
+        // every thread uses the same tags: they are disambiguated by the tag ranges
+        for (long i = 0; i < niter; i += inflight)
+        {
+            for (int j = 0; j < inflight; j++) rreqs[j] = comm.recv(rmsgs[j], peer_rank, j);
+            for (int j = 0; j < inflight; j++) sreqs[j] = comm.send(smsgs[j], peer_rank, j);
+            for (int j = 0; j < inflight; j++)
+            {
+                rreqs[j].wait();
+                sreqs[j].wait();
+            }
+        }
+
+        stats[thread_id].messages = 2 * ((niter + inflight - 1) / inflight) * inflight;
+        stats[thread_id].time = tt.stoc();
+
+        b();
+
+        if (thread_id == 0) elapsed = t0.stoc();
+    }
+
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    const auto inflight = cmd_args.inflight;
+    const auto num_threads = cmd_args.num_threads;
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded, num_threads);
+    barrier b(ctxt, num_threads);
+    report  rep(ctxt, cmd_args, syncmode, waitmode);
+    rep.set("comm_pool", ctxt.get_transport_option("comm_pool"))
+        .set("comm_hints", ctxt.get_transport_option("comm_hints"));
+
+    if (env.rank == 0)
+    {
+        std::cout << "comm pool = " << ctxt.get_transport_option("comm_pool") << std::endl;
+        std::cout << "hints     = " << ctxt.get_transport_option("comm_hints") << std::endl;
+    }
+
+    for (auto buff_size : cmd_args.sizes)
+    {
+        const auto niter = rep.iterations([&](long n)
+            { return run(ctxt, b, cmd_args, buff_size, n, false, rep.threads()); });
+
+        if (env.rank == 0)
+        {
+            std::cout << "inflight  = " << inflight << std::endl;
+            std::cout << "size      = " << buff_size << std::endl;
+            std::cout << "N         = " << niter << std::endl;
+        }
+
+        const auto t = run(ctxt, b, cmd_args, buff_size, niter, true, rep.threads());
+        // messages sent by both ranks and all threads
+        const auto n_msgs = 2.0 * ((niter + inflight - 1) / inflight) * inflight * num_threads;
+        rep(buff_size, niter, t, n_msgs * buff_size, n_msgs);
+    }
+
+    return 0;
+}
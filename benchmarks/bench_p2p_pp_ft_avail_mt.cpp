@@ -13,6 +13,7 @@
 #include "./args.hpp"
 #include "./timer.hpp"
 #include "./utils.hpp"
+#include "./report.hpp"
 //
 #include <atomic>
 #include <iostream>
@@ -52,6 +53,9 @@ std::atomic<int> sends_posted(0);
 std::atomic<int> sends_completed(0);
 std::atomic<int> receives_posted(0);
 
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
 // keep track of sends on a thread local basis
 template<typename Future>
 struct alignas(64) msg_tracker
@@ -75,35 +79,18 @@ struct alignas(64) msg_tracker
     }
 };
 
-int
-main(int argc, char* argv[])
+// send messages for n_secs seconds (or until max_sends messages were sent), returns the elapsed
+// time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, int buff_size, int n_secs, long max_sends,
+    bool verbose, std::vector<thread_stats>& stats)
 {
-    using namespace oomph;
-    using message = oomph::message_buffer<char>;
-
-    args cmd_args(argc, argv, true);
-    if (!cmd_args) return exit(argv[0]);
-    bool const multi_threaded = (cmd_args.num_threads > 1);
-
-    mpi_environment env(multi_threaded, argc, argv);
-    if (env.size != 2) return exit(argv[0]);
-
-    context ctxt(MPI_COMM_WORLD, multi_threaded);
-    barrier b(ctxt, cmd_args.num_threads);
-    timer   t0;
-    timer   t1;
-
     const auto inflight = cmd_args.inflight;
     const auto num_threads = cmd_args.num_threads;
-    const auto n_secs = cmd_args.n_secs;
-    const auto buff_size = cmd_args.buff_size;
 
-    if (env.rank == 0)
-    {
-        std::cout << "inflight = " << inflight << std::endl;
-        std::cout << "size     = " << buff_size << std::endl;
-        std::cout << "S        = " << n_secs << std::endl;
-    }
+    sends_posted = 0;
+    sends_completed = 0;
+    receives_posted = 0;
 
     // How often do we display debug msgs
     const int debug_freq = 5;
@@ -111,7 +98,7 @@ main(int argc, char* argv[])
 
     // true when time exceeded
     std::atomic<bool> time_up = false;
-    // official start time of the test
+    // official start time of the test (set after all threads and ranks are ready)
     auto start = std::chrono::steady_clock::now();
     // last time debug display was shown
     auto dbg_time = start;
@@ -126,7 +113,7 @@ main(int argc, char* argv[])
     std::atomic<int> num_messages_expected = std::numeric_limits<int>::max() / 2;
 
     //    int mode;
-    double       elapsed;
+    double       elapsed = 0;
     oomph::timer ttimer;
 
 #ifdef OOMPH_BENCHMARKS_MT
@@ -158,6 +145,18 @@ main(int argc, char* argv[])
         // NB. these are thread local
         bool thread_sends_complete = false;      // true when thread completed sends
         bool thread_sends_complete_flag = false; // true after thread signals counter
+        long lsent = 0, lrecv = 0;               // messages posted by this thread
+
+        // the peer must have cancelled the receives of a previous run
+        b();
+        timer tt;
+        if (thread_id == 0)
+        {
+            start = std::chrono::steady_clock::now();
+            dbg_time = start;
+            ttimer.tic();
+        }
+        b.thread_barrier();
 
         // loop for allowed time : sending and receiving
         do {
@@ -165,10 +164,12 @@ main(int argc, char* argv[])
             if (thread_id == 0)
             {
                 auto now = std::chrono::steady_clock::now();
-                if (!time_up) time_up = (now > start + std::chrono::seconds{n_secs});
+                if (!time_up)
+                    time_up = (now > start + std::chrono::seconds{n_secs}) ||
+                              (sends_posted >= max_sends);
 
                 // output debug info at periodic intervals
-                if (now > dbg_time + std::chrono::milliseconds{msecond})
+                if (verbose && now > dbg_time + std::chrono::milliseconds{msecond})
                 {
                     dbg_time = now;
                     buffered_out("rank: " << rank << " \tsend: " << sends_posted
@@ -184,6 +185,7 @@ main(int argc, char* argv[])
                 {
                     recvs.reqs[j] = comm.recv(recvs.msgs[j], peer_rank, j);
                     receives_posted++;
+                    lrecv++;
                 }
 
             comm.progress();
@@ -195,6 +197,7 @@ main(int argc, char* argv[])
                 {
                     sends.reqs[j] = comm.send(sends.msgs[j], peer_rank, j);
                     ++sends_posted;
+                    ++lsent;
                 }
 
             comm.progress();
@@ -225,8 +228,9 @@ main(int argc, char* argv[])
                             master_thread = thread_id;
                             // pre-post recv for total incoming messages
                             frecv = comm.recv(done_recv, peer_rank, 0xffff);
-                            buffered_out("rank: " << rank << " thread " << thread_id
-                                                  << " bcast SENDS = " << sends_posted);
+                            if (verbose)
+                                buffered_out("rank: " << rank << " thread " << thread_id
+                                                      << " bcast SENDS = " << sends_posted);
                             std::memcpy(done_send.data(), &sends_posted, sizeof(int));
                             fsend = comm.send(done_send, peer_rank, 0xffff);
                         }
@@ -239,10 +243,11 @@ main(int argc, char* argv[])
                         {
                             int* temp = reinterpret_cast<int*>(done_recv.data());
                             num_messages_expected.store(*temp);
-                            buffered_out(
-                                "rank: " << rank << " thread " << thread_id << " expecting "
-                                         << num_messages_expected << " need receives "
-                                         << num_messages_expected + inflight * num_threads);
+                            if (verbose)
+                                buffered_out(
+                                    "rank: " << rank << " thread " << thread_id << " expecting "
+                                             << num_messages_expected << " need receives "
+                                             << num_messages_expected + inflight * num_threads);
                             // don't re-enter this section
                             sends_complete_checked_flag = true;
                         }
@@ -265,14 +270,19 @@ main(int argc, char* argv[])
         // all ranks have completed sends/recvs : test is over, stop the clock
         // timing includes a few bits of synchronization overhead, but
         // when running for more than a few seconds will be negligable
-        elapsed = ttimer.toc();
+        if (thread_id == 0) elapsed = ttimer.stoc();
+        stats[thread_id].time = tt.stoc();
 
         // cancel outstanding pre-posted receives that we will not use
         for (int j = 0; j < inflight; j++)
         {
             if (!recvs.reqs[j].test())
             {
-                if (recvs.reqs[j].cancel()) receives_posted--;
+                if (recvs.reqs[j].cancel())
+                {
+                    receives_posted--;
+                    lrecv--;
+                }
                 else
                     throw std::runtime_error("Receive cancel failed");
             }
@@ -294,27 +304,52 @@ main(int argc, char* argv[])
             throw std::runtime_error("Final message count mismatch");
         }
 
-        // total traffic is amount sends_posted in both directions
-        if (rank == 0 && thread_id == 0)
+        stats[thread_id].messages = lsent + lrecv;
+
+        b.thread_barrier();
+    }
+
+    return elapsed;
+}
+
+int
+main(int argc, char* argv[])
+{
+    args cmd_args(argc, argv, true);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier b(ctxt, cmd_args.num_threads);
+    report  rep(ctxt, cmd_args, syncmode, waitmode);
+    rep.set("progress", ctxt.get_transport_option("progress"))
+        .set("endpoint", ctxt.get_transport_option("endpoint"));
+
+    const auto n_secs = cmd_args.n_secs;
+    const long max_sends = std::numeric_limits<int>::max() / 4;
+
+    for (auto buff_size : cmd_args.sizes)
+    {
+        if (env.rank == 0)
         {
-            double bw = ((double)(sends_posted + receives_posted) * buff_size) / elapsed;
-            // clang-format off
-            std::cout << "time:       " << elapsed/1000000 << "s\n";
-            std::cout << "final MB/s: " << bw << "\n";
-            std::cout << "CSVData"
-                      << ", niter, " << sends_posted + receives_posted
-                      << ", buff_size, " << buff_size
-                      << ", inflight, " << inflight
-                      << ", num_threads, " << num_threads
-                      << ", syncmode, " << syncmode
-                      << ", waitmode, " << waitmode
-                      << ", transport, " << ctxt.get_transport_option("name")
-                      << ", BW MB/s, " << bw
-                      << ", progress, " << ctxt.get_transport_option("progress")
-                      << ", endpoint, " << ctxt.get_transport_option("endpoint")
-                      << "\n";
-            // clang-format on
+            std::cout << "inflight = " << cmd_args.inflight << std::endl;
+            std::cout << "size     = " << buff_size << std::endl;
+            std::cout << "S        = " << n_secs << std::endl;
         }
+
+        // warmup is bounded by the number of messages
+        if (cmd_args.n_warmup > 0)
+            run(ctxt, b, cmd_args, buff_size, n_secs, cmd_args.n_warmup, false, rep.threads());
+
+        const auto t =
+            run(ctxt, b, cmd_args, buff_size, n_secs, max_sends, true, rep.threads());
+
+        // total traffic is amount sends_posted in both directions
+        const double n_msgs = sends_posted + receives_posted;
+        rep(buff_size, sends_posted + receives_posted, t, n_msgs * buff_size, n_msgs);
     }
 
     return 0;
@@ -0,0 +1,156 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./args.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include "./histogram.hpp"
+#include "./report.hpp"
+#include <chrono>
+#include <vector>
+
+// Small-message latency under bulk load: in every iteration rank 0 posts inflight bulk messages of
+// buff_size bytes to rank 1, followed by a ping of 8 bytes which rank 1 returns as soon as it has
+// arrived. The round trip time of the ping is recorded into a histogram, once with the ping on the
+// normal lane and once with priority::high (the MPI backend needs OOMPH_MPI_PRIORITY_LANE=1 for a
+// separate lane). Each thread runs on a distinct set of tags.
+
+const char* syncmode = "future";
+const char* waitmode = "wait";
+
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
+const std::size_t ping_size = 8;
+
+// niter iterations with buff_size bytes of bulk traffic, returns the elapsed time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, int buff_size, long niter, priority p,
+    bool verbose, std::vector<thread_stats>& stats, histogram& lat)
+{
+    using clock_type = std::chrono::steady_clock;
+
+    timer  t0;
+    double elapsed = 0;
+
+    const auto inflight = cmd_args.inflight;
+    const auto num_threads = cmd_args.num_threads;
+
+    std::vector<histogram> lats(num_threads);
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+#endif
+    {
+        auto       comm = ctxt.get_communicator();
+        const auto rank = comm.rank();
+        const auto thread_id = THREADID;
+        const auto peer_rank = (rank + 1) % 2;
+        const auto bulk_tag = 2 * thread_id;
+        const auto ping_tag = 2 * thread_id + 1;
+        auto&      h = lats[thread_id];
+
+        if (verbose && thread_id == 0 && rank == 0)
+        { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
+
+        std::vector<message> bulk(inflight);
+        for (auto& m : bulk)
+        {
+            m = comm.make_buffer<char>(buff_size);
+            for (auto& c : m) c = 0;
+        }
+        message smsg = comm.make_buffer<char>(ping_size);
+        message rmsg = comm.make_buffer<char>(ping_size);
+        for (auto& c : smsg) c = 0;
+
+        b();
+
+        timer tt;
+        if (thread_id == 0) t0.tic();
+
+        for (long i = 0; i < niter; ++i)
+        {
+            if (rank == 0)
+            {
+                for (auto& m : bulk) comm.send(m, peer_rank, bulk_tag);
+                auto       rreq = comm.recv(rmsg, peer_rank, ping_tag, p);
+                const auto start = clock_type::now();
+                comm.send(smsg, peer_rank, ping_tag, p);
+                rreq.wait();
+                h(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start)
+                        .count());
+            }
+            else
+            {
+                for (auto& m : bulk) comm.recv(m, peer_rank, bulk_tag);
+                comm.recv(rmsg, peer_rank, ping_tag, p).wait();
+                comm.send(smsg, peer_rank, ping_tag, p);
+            }
+            comm.wait_all();
+        }
+
+        stats[thread_id].messages = niter * (inflight + 2);
+        stats[thread_id].time = tt.stoc();
+
+        b();
+
+        if (thread_id == 0) elapsed = t0.stoc();
+    }
+
+    lat.clear();
+    for (auto const& h : lats) lat(h);
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    context   ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier   b(ctxt, cmd_args.num_threads);
+    report    rep(ctxt, cmd_args, syncmode, waitmode);
+    histogram lat;
+
+    for (auto buff_size : cmd_args.sizes)
+    {
+        for (auto p : {priority::normal, priority::high})
+        {
+            const char* lane = (p == priority::high) ? "high" : "normal";
+            const auto  niter = rep.iterations([&](long n)
+                { return run(ctxt, b, cmd_args, buff_size, n, p, false, rep.threads(), lat); });
+
+            if (env.rank == 0)
+            {
+                std::cout << "priority = " << lane << std::endl;
+                std::cout << "inflight = " << cmd_args.inflight << std::endl;
+                std::cout << "size     = " << buff_size << std::endl;
+                std::cout << "N        = " << niter << std::endl;
+            }
+
+            const auto t = run(ctxt, b, cmd_args, buff_size, niter, p, true, rep.threads(), lat);
+            // bulk messages and pings of all threads
+            const auto n_bulk = (double)niter * cmd_args.inflight * cmd_args.num_threads;
+            const auto n_ping = 2.0 * niter * cmd_args.num_threads;
+            rep.record("priority", lane);
+            rep(buff_size, niter, t, n_bulk * buff_size + n_ping * ping_size, n_bulk + n_ping,
+                &lat);
+        }
+    }
+
+    return 0;
+}
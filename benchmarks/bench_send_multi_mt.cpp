@@ -0,0 +1,121 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Neighbor-count scaling of send_multi: every rank sends one message to k = 1, 2, 4, ... up to
+// max_neighbors destinations (wrapping around the ranks, with one tag per destination) and
+// compares one send_multi call against k individual sends. Runs with any number of ranks >= 2.
+
+int
+main(int argc, char** argv)
+{
+    using namespace oomph;
+    using message = oomph::message_buffer<char>;
+
+    if (argc != 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " [niter] [msg_size] [max_neighbors]" << std::endl;
+        return 1;
+    }
+    const int niter = std::atoi(argv[1]);
+    const int buff_size = std::atoi(argv[2]);
+    const int max_neighs = std::atoi(argv[3]);
+
+    mpi_environment env(false, argc, argv);
+    if (env.size < 2) return exit(argv[0]);
+
+    context ctxt(MPI_COMM_WORLD, false);
+    barrier b(ctxt);
+    auto    comm = ctxt.get_communicator();
+
+    if (env.rank == 0)
+    {
+        std::cout << "\n\nrunning test " << __FILE__ << "\n\n";
+        std::cout << "size      = " << buff_size << std::endl;
+        std::cout << "N         = " << niter << std::endl;
+    }
+
+    auto                 smsg = comm.make_buffer<char>(buff_size);
+    std::vector<message> rmsgs(max_neighs);
+    for (auto& c : smsg) c = 0;
+    for (auto& m : rmsgs) m = comm.make_buffer<char>(buff_size);
+
+    for (int k = 1; k <= max_neighs; k *= 2)
+    {
+        std::vector<rank_type> dsts(k);
+        std::vector<tag_type>  tags(k);
+        for (int i = 0; i < k; ++i)
+        {
+            dsts[i] = (env.rank + 1 + i % (env.size - 1)) % env.size;
+            tags[i] = i;
+        }
+
+        auto post_recvs = [&]()
+        {
+            std::vector<recv_request> rreqs;
+            rreqs.reserve(k);
+            for (int i = 0; i < k; ++i)
+            {
+                auto const src = (env.rank + env.size - 1 - i % (env.size - 1)) % env.size;
+                rreqs.push_back(comm.recv(rmsgs[i], src, i));
+            }
+            return rreqs;
+        };
+
+        for (const char* mode : {"multi", "loop"})
+        {
+            bool const multi = (mode[0] == 'm');
+            timer      t0;
+            b.rank_barrier();
+            t0.tic();
+            for (int n = 0; n < niter; ++n)
+            {
+                auto rreqs = post_recvs();
+                if (multi) { comm.send_multi(smsg, dsts, tags).wait(); }
+                else
+                {
+                    std::vector<send_request> sreqs;
+                    sreqs.reserve(k);
+                    for (int i = 0; i < k; ++i) sreqs.push_back(comm.send(smsg, dsts[i], tags[i]));
+                    for (auto& r : sreqs) r.wait();
+                }
+                for (auto& r : rreqs) r.wait();
+            }
+            auto const t = t0.stoc();
+            b.rank_barrier();
+
+            if (env.rank == 0)
+            {
+                auto const us = t / niter;
+                // clang-format off
+                std::cout << "neighbors: " << k << ", " << mode << " us: " << us << "\n";
+                std::cout << "CSVData"
+                          << ", niter, " << niter
+                          << ", buff_size, " << buff_size
+                          << ", num_ranks, " << env.size
+                          << ", neighbors, " << k
+                          << ", mode, " << mode
+                          << ", transport, " << ctxt.get_transport_option("name")
+                          << ", us per exchange, " << us
+                          << "\n";
+                // clang-format on
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <oomph/barrier.hpp>
+#include "./mpi_environment.hpp"
+#include "./args.hpp"
+#include "./timer.hpp"
+#include "./utils.hpp"
+#include "./report.hpp"
+#include <string>
+#include <vector>
+
+// Receive paths under thread contention: every thread exchanges inflight messages per iteration
+// with the peer and waits for them. The receives are posted as
+//   recv             per-thread receives on per-thread tags
+//   recv_any         per-thread receives from any_source with any_tag
+//   shared_recv      shared receives on per-thread tags
+//   shared_recv_any  shared receives from any_source with any_tag
+// A shared receive may be completed by the progress of any thread. The per-thread breakdown counts
+// the receive callbacks which ran on each thread, and fairness is Jain's index over these counts
+// (1 when all threads service the same number of receives, 1/num_threads at worst).
+
+const char* waitmode = "wait";
+
+using namespace oomph;
+using message = oomph::message_buffer<char>;
+
+enum class mode
+{
+    recv,
+    recv_any,
+    shared_recv,
+    shared_recv_any
+};
+
+// every thread sends and receives niter messages of buff_size bytes, returns the elapsed time [us]
+double
+run(context& ctxt, barrier& b, args const& cmd_args, mode m, int buff_size, long niter,
+    bool verbose, std::vector<thread_stats>& stats)
+{
+    timer  t0;
+    double elapsed = 0;
+
+    const auto inflight = cmd_args.inflight;
+    const bool shared = (m == mode::shared_recv || m == mode::shared_recv_any);
+    const bool any = (m == mode::recv_any || m == mode::shared_recv_any);
+
+#ifdef OOMPH_BENCHMARKS_MT
+#pragma omp parallel
+#endif
+    {
+        auto       comm = ctxt.get_communicator();
+        const auto rank = comm.rank();
+        const auto thread_id = THREADID;
+        const auto peer_rank = (rank + 1) % 2;
+        const auto src = any ? communicator::any_source : peer_rank;
+
+        // callbacks may run on any thread: count on the executing one
+        auto recv_callback = [&stats](message&, rank_type, tag_type) { ++stats[THREADID].messages; };
+
+        if (verbose && thread_id == 0 && rank == 0)
+        { std::cout << "\n\nrunning test " << __FILE__ << "\n\n"; };
+
+        std::vector<message>             smsgs(inflight);
+        std::vector<message>             rmsgs(inflight);
+        std::vector<send_request>        sreqs(inflight);
+        std::vector<recv_request>        rreqs(inflight);
+        std::vector<shared_recv_request> srreqs(inflight);
+        for (int j = 0; j < inflight; j++)
+        {
+            smsgs[j] = comm.make_buffer<char>(buff_size);
+            rmsgs[j] = comm.make_buffer<char>(buff_size);
+            for (auto& c : smsgs[j]) c = 0;
+            for (auto& c : rmsgs[j]) c = 0;
+        }
+
+        b();
+
+        timer tt;
+        if (thread_id == 0) t0.tic();
+
+        for (long i = 0; i < niter; i += inflight)
+        {
+            for (int j = 0; j < inflight; j++)
+            {
+                const auto tag = any ? communicator::any_tag : thread_id * inflight + j;
+                if (shared) srreqs[j] = comm.shared_recv(rmsgs[j], src, tag, recv_callback);
+                else
+                    rreqs[j] = comm.recv(rmsgs[j], src, tag, recv_callback);
+            }
+            for (int j = 0; j < inflight; j++)
+                sreqs[j] = comm.send(smsgs[j], peer_rank, thread_id * inflight + j);
+            for (int j = 0; j < inflight; j++)
+            {
+                sreqs[j].wait();
+                if (shared) srreqs[j].wait();
+                else
+                    rreqs[j].wait();
+            }
+        }
+
+        stats[thread_id].time = tt.stoc();
+
+        b();
+
+        if (thread_id == 0) elapsed = t0.stoc();
+    }
+
+    return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+    args cmd_args(argc, argv);
+    if (!cmd_args) return exit(argv[0]);
+    bool const multi_threaded = (cmd_args.num_threads > 1);
+
+    mpi_environment env(multi_threaded, argc, argv);
+    if (env.size != 2) return exit(argv[0]);
+
+    const auto inflight = cmd_args.inflight;
+    const auto num_threads = cmd_args.num_threads;
+
+    context ctxt(MPI_COMM_WORLD, multi_threaded);
+    barrier b(ctxt, num_threads);
+
+    for (auto m : {mode::recv, mode::recv_any, mode::shared_recv, mode::shared_recv_any})
+    {
+        const char* syncmode = (m == mode::recv)          ? "recv"
+                               : (m == mode::recv_any)    ? "recv_any"
+                               : (m == mode::shared_recv) ? "shared_recv"
+                                                          : "shared_recv_any";
+        report rep(ctxt, cmd_args, syncmode, waitmode);
+        rep.set("progress", ctxt.get_transport_option("progress"))
+            .set("endpoint", ctxt.get_transport_option("endpoint"));
+
+        for (auto buff_size : cmd_args.sizes)
+        {
+            const auto niter = rep.iterations([&](long n)
+                { return run(ctxt, b, cmd_args, m, buff_size, n, false, rep.threads()); });
+            for (auto& s : rep.threads()) s = thread_stats{};
+
+            if (env.rank == 0)
+            {
+                std::cout << "mode     = " << syncmode << std::endl;
+                std::cout << "inflight = " << inflight << std::endl;
+                std::cout << "size     = " << buff_size << std::endl;
+                std::cout << "N        = " << niter << std::endl;
+            }
+
+            const auto t = run(ctxt, b, cmd_args, m, buff_size, niter, true, rep.threads());
+
+            // Jain's fairness index over the receives serviced per thread, worst rank
+            double sum = 0, sum_sq = 0;
+            for (auto const& s : rep.threads())
+            {
+                sum += s.messages;
+                sum_sq += (double)s.messages * s.messages;
+            }
+            double fairness = sum_sq > 0 ? (sum * sum) / (num_threads * sum_sq) : 1.0;
+            MPI_Allreduce(MPI_IN_PLACE, &fairness, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+            rep.record("fairness", std::to_string(fairness));
+
+            // messages received by both ranks and all threads
+            const auto n_msgs = 2.0 * ((niter + inflight - 1) / inflight) * inflight * num_threads;
+            rep(buff_size, niter, t, n_msgs * buff_size, n_msgs);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/util/unique_function.hpp>
+#include <oomph/util/unsafe_shared_ptr.hpp>
+#include <oomph/util/pool_factory.hpp>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Serial microbenchmarks of the utilities on the send/recv path: construction, move, invocation
+// and destruction of unique_function for capture sizes inside and beyond the small buffer,
+// reference counting of unsafe_shared_ptr (with std::shared_ptr as baseline), and allocation
+// throughput of pool_factory (with heap allocation as baseline). Reports ns per operation.
+
+namespace
+{
+// keep the compiler from optimizing a value away
+template<typename T>
+inline void
+do_not_optimize(T const& x)
+{
+    asm volatile("" : : "r,m"(x) : "memory");
+}
+
+template<typename F>
+double
+ns_per_op(long niter, F&& f)
+{
+    using clock_type = std::chrono::steady_clock;
+    const auto start = clock_type::now();
+    for (long i = 0; i < niter; ++i) f(i);
+    const auto t = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+    return t / niter;
+}
+
+void
+print(char const* bench, char const* op, std::size_t capture, char const* storage, double ns)
+{
+    // clang-format off
+    std::cout << bench << " " << op << " (" << capture << " bytes, " << storage << "): " << ns
+              << " ns\n";
+    std::cout << "CSVData"
+              << ", benchmark, " << bench
+              << ", op, " << op
+              << ", size, " << capture
+              << ", storage, " << storage
+              << ", ns/op, " << ns
+              << "\n";
+    // clang-format on
+}
+
+// function object with a capture of N bytes
+template<std::size_t N>
+struct capture
+{
+    std::array<char, N> m_data;
+
+    capture() { m_data.fill(1); }
+    int operator()(int x) const noexcept { return x + m_data[0]; }
+};
+
+template<std::size_t N>
+void
+bench_unique_function(long niter)
+{
+    using function_type = oomph::util::unique_function<int(int)>;
+    char const* storage = (sizeof(capture<N>) <= 40) ? "sbo" : "heap";
+
+    print("unique_function", "construct+destroy", N, storage,
+        ns_per_op(niter, [](long) {
+            function_type f{capture<N>{}};
+            do_not_optimize(f);
+        }));
+
+    function_type a{capture<N>{}};
+    function_type b;
+    print("unique_function", "move", N, storage,
+        ns_per_op(niter, [&](long i) {
+            if (i & 1) a = std::move(b);
+            else
+                b = std::move(a);
+            do_not_optimize(a);
+            do_not_optimize(b);
+        }));
+
+    function_type f{capture<N>{}};
+    int           sum = 0;
+    print("unique_function", "invoke", N, storage,
+        ns_per_op(niter, [&](long i) {
+            sum += f((int)i);
+            do_not_optimize(sum);
+        }));
+}
+
+struct payload
+{
+    std::array<char, 64> m_data;
+};
+
+void
+bench_shared_ptr(long niter)
+{
+    using namespace oomph::util;
+
+    print("unsafe_shared_ptr", "make+destroy", sizeof(payload), "heap",
+        ns_per_op(niter, [](long) {
+            auto p = make_shared<payload>();
+            do_not_optimize(p);
+        }));
+    print("std::shared_ptr", "make+destroy", sizeof(payload), "heap",
+        ns_per_op(niter, [](long) {
+            auto p = std::make_shared<payload>();
+            do_not_optimize(p);
+        }));
+
+    auto u = make_shared<payload>();
+    print("unsafe_shared_ptr", "copy+destroy", sizeof(payload), "heap",
+        ns_per_op(niter, [&](long) {
+            auto p = u;
+            do_not_optimize(p);
+        }));
+    auto s = std::make_shared<payload>();
+    print("std::shared_ptr", "copy+destroy", sizeof(payload), "heap",
+        ns_per_op(niter, [&](long) {
+            auto p = s;
+            do_not_optimize(p);
+        }));
+
+    unsafe_shared_ptr<payload> u2;
+    print("unsafe_shared_ptr", "move", sizeof(payload), "heap",
+        ns_per_op(niter, [&](long i) {
+            if (i & 1) u = std::move(u2);
+            else
+                u2 = std::move(u);
+            do_not_optimize(u);
+        }));
+}
+
+void
+bench_pool_factory(long niter)
+{
+    using namespace oomph::util;
+    pool_factory<payload> factory;
+
+    print("pool_factory", "make+destroy", sizeof(payload), "pool",
+        ns_per_op(niter, [&](long) {
+            auto p = factory.make();
+            do_not_optimize(p);
+        }));
+
+    // many live objects: exercises the free list instead of a single recycled chunk
+    constexpr long                                   batch = 1024;
+    std::vector<pool_factory<payload>::ptr_type>     pool_ptrs(batch);
+    std::vector<unsafe_shared_ptr<payload>>          heap_ptrs(batch);
+    print("pool_factory", "make+destroy batched", sizeof(payload), "pool",
+        ns_per_op(niter, [&](long i) {
+            pool_ptrs[i % batch] = factory.make();
+            do_not_optimize(pool_ptrs[i % batch]);
+        }));
+    print("make_shared", "make+destroy batched", sizeof(payload), "heap",
+        ns_per_op(niter, [&](long i) {
+            heap_ptrs[i % batch] = make_shared<payload>();
+            do_not_optimize(heap_ptrs[i % batch]);
+        }));
+}
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    if (argc > 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " [niter]" << std::endl;
+        return 1;
+    }
+    const long niter = (argc == 2) ? std::atol(argv[1]) : 10000000l;
+
+    std::cout << "\n\nrunning test " << __FILE__ << "\n\n";
+    std::cout << "N         = " << niter << std::endl;
+
+    bench_unique_function<8>(niter);
+    bench_unique_function<24>(niter);
+    bench_unique_function<40>(niter);
+    bench_unique_function<48>(niter);
+    bench_unique_function<128>(niter);
+    bench_shared_ptr(niter);
+    bench_pool_factory(niter);
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <mpi.h>
+#include <vector>
+
+namespace oomph
+{
+/** @brief HDR-style histogram of non-negative integer samples (e.g. latencies in ns).
+  *
+  * Samples are recorded into power-of-two buckets which are subdivided into 2^sub_bucket_bits
+  * linear sub-buckets, so recording is O(1), memory is fixed and the relative error of a
+  * reported value is below 2^-sub_bucket_bits. Samples beyond the covered range are clamped to
+  * the last sub-bucket. */
+class histogram
+{
+  public: // member types
+    using size_type = std::size_t;
+    using value_type = std::uint64_t;
+
+  public: // static members
+    static constexpr int       sub_bucket_bits = 7;
+    static constexpr int       num_buckets = 40;
+    static constexpr size_type sub_bucket_count = size_type(1) << sub_bucket_bits;
+    static constexpr size_type num_counts = (num_buckets + 1) * sub_bucket_count;
+
+  private: // members
+    std::vector<std::uint64_t> m_counts;
+    size_type                  m_num_samples = 0u;
+    value_type                 m_min = std::numeric_limits<value_type>::max();
+    value_type                 m_max = 0u;
+
+  public: // ctors
+    histogram()
+    : m_counts(num_counts, 0u)
+    {
+    }
+    histogram(const histogram&) = default;
+    histogram(histogram&&) noexcept = default;
+    histogram& operator=(const histogram&) = default;
+    histogram& operator=(histogram&&) noexcept = default;
+
+  public: // return statistics
+    inline size_type  num_samples() const noexcept { return m_num_samples; }
+    inline value_type min() const noexcept { return m_num_samples ? m_min : 0u; }
+    inline value_type max() const noexcept { return m_max; }
+
+    /** @brief value below or at which the given percentage of samples fall
+              * @param p percentage in [0, 100]
+              * @return highest value equivalent to the sub-bucket which holds the percentile */
+    inline value_type percentile(double p) const noexcept
+    {
+        if (m_num_samples == 0) return 0u;
+        const auto target = std::max<size_type>(1u,
+            (size_type)(std::min(p, 100.0) / 100.0 * m_num_samples + 0.5));
+        size_type sum = 0u;
+        for (size_type i = 0; i < num_counts; ++i)
+        {
+            sum += m_counts[i];
+            if (sum < target) continue;
+            if (i == num_counts - 1) return m_max;
+            return std::min(std::max(highest_value(i), m_min), m_max);
+        }
+        return m_max;
+    }
+
+  public: // add samples
+    /** @brief record one sample
+              * @param sample a sample
+              * @return reference to this object */
+    inline histogram& operator()(value_type sample) noexcept
+    {
+        ++m_counts[index(sample)];
+        ++m_num_samples;
+        m_min = std::min(m_min, sample);
+        m_max = std::max(m_max, sample);
+        return *this;
+    }
+
+    /** @brief merge another histogram
+              * @param other another histogram object
+              * @return reference to this object */
+    inline histogram& operator()(const histogram& other) noexcept
+    {
+        for (size_type i = 0; i < num_counts; ++i) m_counts[i] += other.m_counts[i];
+        m_num_samples += other.m_num_samples;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        return *this;
+    }
+
+    /** @brief reset histogram */
+    inline void clear() noexcept
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0u);
+        m_num_samples = 0u;
+        m_min = std::numeric_limits<value_type>::max();
+        m_max = 0u;
+    }
+
+  private:
+    static inline size_type index(value_type v) noexcept
+    {
+        if (v < sub_bucket_count) return v;
+        int msb = 0;
+        while ((v >> (msb + 1)) != 0u) ++msb;
+        const int bucket = msb - sub_bucket_bits + 1;
+        if (bucket > num_buckets) return num_counts - 1;
+        return bucket * sub_bucket_count + ((v >> (bucket - 1)) - sub_bucket_count);
+    }
+
+    static inline value_type highest_value(size_type i) noexcept
+    {
+        if (i < sub_bucket_count) return i;
+        const auto bucket = i / sub_bucket_count;
+        const auto sub = (i % sub_bucket_count) + sub_bucket_count;
+        return ((sub + 1) << (bucket - 1)) - 1;
+    }
+
+    friend histogram reduce(const histogram&, MPI_Comm);
+
+  public:
+    /**  @brief print percentiles to output stream */
+    template<class CharT, class Traits = std::char_traits<CharT>>
+    friend std::basic_ostream<CharT, Traits>& operator<<(
+        std::basic_ostream<CharT, Traits>& os, const histogram& h)
+    {
+        os << "[" << h.min() << "," << h.percentile(50) << "," << h.percentile(90) << ","
+           << h.percentile(99) << "," << h.percentile(99.9) << "," << h.max() << "] ("
+           << h.num_samples() << ")";
+        return os;
+    }
+};
+
+/** @brief all-reduce histograms over the MPI group defined by the communicator
+          * @param h histogram local to each rank
+          * @param comm MPI communicator
+          * @return combined histogram incorporating all samples */
+inline histogram
+reduce(const histogram& h, MPI_Comm comm)
+{
+    histogram h_all;
+    MPI_Allreduce(h.m_counts.data(), h_all.m_counts.data(), histogram::num_counts, MPI_UINT64_T,
+        MPI_SUM, comm);
+    std::uint64_t local[3] = {h.m_num_samples, h.m_min, h.m_max};
+    std::uint64_t global[3];
+    MPI_Allreduce(&local[0], &global[0], 1, MPI_UINT64_T, MPI_SUM, comm);
+    MPI_Allreduce(&local[1], &global[1], 1, MPI_UINT64_T, MPI_MIN, comm);
+    MPI_Allreduce(&local[2], &global[2], 1, MPI_UINT64_T, MPI_MAX, comm);
+    h_all.m_num_samples = global[0];
+    h_all.m_min = global[1];
+    h_all.m_max = global[2];
+    return h_all;
+}
+
+} // namespace oomph
@@ -0,0 +1,194 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <oomph/context.hpp>
+#include "./args.hpp"
+#include "./histogram.hpp"
+#include <mpi.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace oomph
+{
+/** @brief per-thread counters of a measured run */
+struct alignas(64) thread_stats
+{
+    long   messages = 0; // messages completed by the thread
+    double time = 0;     // time spent by the thread in the measured loop [us]
+};
+
+/** @brief drives warmup and iteration count calibration for every message size of a sweep, and
+  * prints the results on rank 0, either as a CSVData line followed by one CSVThread line per rank
+  * and thread, or as a single JSONData line */
+class report
+{
+  private: // member types
+    using field = std::pair<std::string, std::string>;
+
+  private: // members
+    args const&               m_args;
+    int                       m_rank;
+    int                       m_size;
+    std::vector<field>        m_fields;
+    std::vector<field>        m_record;
+    std::vector<thread_stats> m_threads;
+
+  public: // ctors
+    report(context const& ctxt, args const& a, char const* syncmode, char const* waitmode)
+    : m_args{a}
+    , m_threads(a.num_threads)
+    {
+        MPI_Comm_rank(MPI_COMM_WORLD, &m_rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &m_size);
+        set("syncmode", syncmode);
+        set("waitmode", waitmode);
+        set("transport", ctxt.get_transport_option("name"));
+    }
+
+  public: // member functions
+    /** @brief add a key/value pair to all records */
+    report& set(char const* key, std::string value)
+    {
+        m_fields.emplace_back(key, std::move(value));
+        return *this;
+    }
+
+    /** @brief add a key/value pair to the next record only */
+    report& record(char const* key, std::string value)
+    {
+        m_record.emplace_back(key, std::move(value));
+        return *this;
+    }
+
+    /** @brief per-thread counters, to be filled in by the measured run */
+    std::vector<thread_stats>& threads() noexcept { return m_threads; }
+
+    /** @brief run the warmup iterations and return the number of iterations to measure
+      * @param run callable performing n iterations and returning the elapsed time [us] */
+    template<typename Run>
+    long iterations(Run&& run)
+    {
+        long const niter = m_args.n_iter;
+        if (m_args.n_warmup <= 0) return niter;
+        double const t = run((long)m_args.n_warmup);
+        if (!m_args.timed) return niter;
+        // scale to the requested duration; all ranks must agree on the iteration count
+        long n = std::max(1l, (long)(m_args.n_warmup * (m_args.n_secs * 1.0e6) / std::max(t, 1.0)));
+        if (niter > 0) n = std::min(n, niter);
+        MPI_Allreduce(MPI_IN_PLACE, &n, 1, MPI_LONG, MPI_MIN, MPI_COMM_WORLD);
+        return n;
+    }
+
+    /** @brief print the results of one message size (collective over all ranks)
+      * @param buff_size message size
+      * @param niter number of measured iterations
+      * @param time elapsed time [us]
+      * @param bytes number of bytes transferred by all ranks
+      * @param messages number of messages transferred by all ranks
+      * @param latency optional latency histogram [ns], percentiles are added to the record */
+    void operator()(int buff_size, long niter, double time, double bytes, double messages,
+        histogram const* latency = nullptr)
+    {
+        static double const percentiles[] = {50, 90, 99, 99.9};
+        histogram           lat;
+        if (latency) lat = reduce(*latency, MPI_COMM_WORLD);
+
+        std::vector<double> local;
+        for (auto const& s : m_threads)
+        {
+            local.push_back(s.messages);
+            local.push_back(s.time);
+        }
+        std::vector<double> all(m_rank == 0 ? local.size() * m_size : 0);
+        MPI_Gather(local.data(), local.size(), MPI_DOUBLE, all.data(), local.size(), MPI_DOUBLE, 0,
+            MPI_COMM_WORLD);
+        for (auto& s : m_threads) s = thread_stats{};
+        auto fields = m_fields;
+        fields.insert(fields.end(), m_record.begin(), m_record.end());
+        m_record.clear();
+        if (m_rank != 0) return;
+
+        double const bw = bytes / time;
+        double const rate = messages / (time / 1000000);
+        // clang-format off
+        std::cout << "time:        " << time / 1000000 << "s\n";
+        std::cout << "final MB/s:  " << bw << "\n";
+        std::cout << "final msg/s: " << rate << "\n";
+        if (latency) std::cout << "latency ns [min,p50,p90,p99,p99.9,max]: " << lat << "\n";
+        if (m_args.format == args::output_format::csv)
+        {
+            std::cout << "CSVData"
+                      << ", niter, " << niter
+                      << ", buff_size, " << buff_size
+                      << ", inflight, " << m_args.inflight
+                      << ", num_threads, " << m_args.num_threads;
+            for (auto const& f : fields) std::cout << ", " << f.first << ", " << f.second;
+            std::cout << ", BW MB/s, " << bw
+                      << ", msg/s, " << rate
+                      << ", time s, " << time / 1000000;
+            if (latency)
+            {
+                std::cout << ", min us, " << lat.min() / 1000.0;
+                for (auto p : percentiles) std::cout << ", p" << p << " us, " << lat.percentile(p) / 1000.0;
+                std::cout << ", max us, " << lat.max() / 1000.0;
+            }
+            std::cout << "\n";
+            for (std::size_t i = 0; i < all.size() / 2; ++i)
+                std::cout << "CSVThread"
+                          << ", buff_size, " << buff_size
+                          << ", rank, " << i / m_threads.size()
+                          << ", thread, " << i % m_threads.size()
+                          << ", messages, " << (long)all[2 * i]
+                          << ", msg/s, " << thread_rate(all[2 * i], all[2 * i + 1])
+                          << "\n";
+        }
+        else
+        {
+            std::cout << "JSONData {"
+                      << "\"niter\": " << niter
+                      << ", \"buff_size\": " << buff_size
+                      << ", \"inflight\": " << m_args.inflight
+                      << ", \"num_threads\": " << m_args.num_threads;
+            for (auto const& f : fields) std::cout << ", \"" << f.first << "\": \"" << f.second << "\"";
+            std::cout << ", \"bw_MBps\": " << bw
+                      << ", \"msg_rate\": " << rate
+                      << ", \"time_s\": " << time / 1000000;
+            if (latency)
+            {
+                std::cout << ", \"min_us\": " << lat.min() / 1000.0;
+                for (auto p : percentiles) std::cout << ", \"p" << p << "_us\": " << lat.percentile(p) / 1000.0;
+                std::cout << ", \"max_us\": " << lat.max() / 1000.0;
+            }
+            std::cout << ", \"threads\": [";
+            for (std::size_t i = 0; i < all.size() / 2; ++i)
+                std::cout << (i ? ", " : "")
+                          << "{\"rank\": " << i / m_threads.size()
+                          << ", \"thread\": " << i % m_threads.size()
+                          << ", \"messages\": " << (long)all[2 * i]
+                          << ", \"msg_rate\": " << thread_rate(all[2 * i], all[2 * i + 1])
+                          << "}";
+            std::cout << "]}\n";
+        }
+        // clang-format on
+        std::cout.flush();
+    }
+
+  private:
+    static double thread_rate(double messages, double time)
+    {
+        return time > 0 ? messages / (time / 1000000) : 0.0;
+    }
+};
+
+} // namespace oomph
@@ -23,6 +23,8 @@ inline int
 exit(char const* executable)
 {
     std::cerr << "Usage: " << executable << " [niter] [msg_size] [inflight]" << std::endl;
+    std::cerr << "       msg_size may be a sweep min:max[:factor]" << std::endl;
+    std::cerr << "       options: -t secs (timed), -w n (warmup), -o csv|json" << std::endl;
     std::cerr << "       run with 2 MPI processes: e.g.: mpirun -np 2 ..." << std::endl;
     return 1;
 }
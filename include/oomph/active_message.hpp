@@ -0,0 +1,54 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <oomph/types.hpp>
+#include <oomph/util/unique_function.hpp>
+
+namespace oomph
+{
+using am_id = std::uint32_t;
+
+// An active message as seen by its handler. Header and payload point into buffers of the library
+// (for eager messages, straight into the receive buffer) and are only valid during the call.
+struct am_message
+{
+    rank_type   m_src;
+    am_id       m_id;
+    void const* m_header;
+    std::size_t m_header_size;
+    void const* m_payload;
+    std::size_t m_payload_size;
+
+    template<typename T>
+    T const* header() const noexcept
+    {
+        return static_cast<T const*>(m_header);
+    }
+
+    template<typename T>
+    T const* payload() const noexcept
+    {
+        return static_cast<T const*>(m_payload);
+    }
+
+    // number of payload elements of type T
+    template<typename T>
+    std::size_t payload_size() const noexcept
+    {
+        return m_payload_size / sizeof(T);
+    }
+};
+
+using am_handler = util::unique_function<void(am_message const&)>;
+
+} // namespace oomph
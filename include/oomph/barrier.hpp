@@ -13,10 +13,14 @@
 
 #if OOMPH_ENABLE_BARRIER
 #include <atomic>
+#include <cstdint>
 #include <oomph/context.hpp>
+#include <oomph/util/heap_pimpl.hpp>
 
 namespace oomph
 {
+class hierarchical_barrier;
+
 /**
 The barrier object synchronize threads or ranks, or both. When synchronizing
 ranks, it also progress the communicator.
@@ -26,25 +30,53 @@ Halo-exchanges doe not need, in general, to call barriers.
 
 Note on the implementation:
 
-The implementation follows a two-counter approach:
-First: one (atomic) counter is increased to the number of threads participating.
-Second: one (atomic) counter is decreased from the numner of threads
+The thread barrier is a sense-reversing centralized barrier: threads arrive by
+incrementing a counter with fetch_add, and the last one to arrive resets the
+counter and flips the sense (a generation number) on which the others spin.
+Counter and sense live on separate cache lines.
 
-The global barrier performs the up-counting while the thread that reaches the
-final value also perform the rank-barrier. After that the downward count is
-performed as usual.
+The global barrier passes the thread barrier twice. The thread that arrives
+last in the first pass also performs the rank-barrier, while the other threads
+wait (and progress) in the second pass.
 
 This is why the barrier is split into is_node1 and in_node2. in_node1 returns
 true to the thread selected to run the rank_barrier in the full barrier.
+
+The rank barrier is topology aware: ranks on the same node synchronize through
+shared memory, and only one leader per node takes part in the inter-node
+dissemination barrier. The construction and destruction of a barrier object are
+therefore collective over the ranks of the context.
 */
 class barrier
 {
+  public: // member types
+    /**
+     * Handle to one split-phase barrier epoch, obtained from arrive() and passed to test() or
+     * wait().
+     */
+    class token
+    {
+        friend class barrier;
+
+        std::uint64_t m_epoch = 0;
+        bool          m_owner = false;
+    };
+
+  private: // member types
+    struct alignas(64) padded_counter
+    {
+        std::atomic<std::uint64_t> m{0};
+    };
+
   private: // members
-    std::size_t                 m_threads;
-    mutable std::atomic<size_t> b_count{0};
-    mutable std::atomic<size_t> b_count2;
-    MPI_Comm                    m_mpi_comm;
-    context_impl const*         m_context;
+    std::size_t                                    m_threads;
+    MPI_Comm                                       m_mpi_comm;
+    context_impl const*                            m_context;
+    mutable util::heap_pimpl<hierarchical_barrier> m_rank_barrier;
+    mutable padded_counter                         m_count;
+    mutable padded_counter                         m_sense;
+    mutable padded_counter                         m_arrived;
+    mutable padded_counter                         m_completed;
 
     friend class test_barrier;
 
@@ -52,6 +84,7 @@ class barrier
     barrier(context const& c, size_t n_threads = 1);
     barrier(const barrier&) = delete;
     barrier(barrier&&) = delete;
+    ~barrier();
 
   public: // public member functions
     int size() const noexcept { return m_threads; }
@@ -72,11 +105,21 @@ class barrier
      * is indicated in the construction of the barrier object, whose reference is shared among the
      * participating threads.
      */
-    void thread_barrier() const
-    {
-        in_node1();
-        in_node2();
-    }
+    void thread_barrier() const { in_node1(); }
+
+    /**
+     * Split-phase version of the full barrier: announce the arrival of the calling thread and
+     * return immediately. Local work may be done before the barrier is completed with test() or
+     * wait(). Every participating thread must complete its token before it arrives again, and
+     * the split-phase functions must not be mixed with the blocking ones while tokens are pending.
+     */
+    token arrive() const;
+
+    /** Advance the barrier without blocking, returns true once all threads and ranks arrived. */
+    bool test(token& t) const;
+
+    /** Complete the barrier, progressing the communicators while waiting. */
+    void wait(token& t) const;
 
   private:
     bool in_node1() const;
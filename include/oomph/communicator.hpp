@@ -16,8 +16,12 @@
 #include <string>
 #include <hwmalloc/device.hpp>
 #include <oomph/config.hpp>
+#include <oomph/active_message.hpp>
 #include <oomph/message_buffer.hpp>
+#include <oomph/rma.hpp>
+#include <oomph/recv_stream.hpp>
 #include <oomph/detail/communicator_helper.hpp>
+#include <oomph/detail/allreduce_state.hpp>
 #include <oomph/util/mpi_error.hpp>
 #include <oomph/util/unique_function.hpp>
 
@@ -91,6 +95,8 @@ class communicator
     rank_type   size() const noexcept;
     MPI_Comm    mpi_comm() const noexcept;
     bool        is_local(rank_type rank) const noexcept;
+    // tags are in [0, max_tag()] (or any_tag for receives), operations with other tags throw
+    tag_type    max_tag() const noexcept;
     std::size_t scheduled_sends() const noexcept { return m_state->scheduled_sends; }
     std::size_t scheduled_recvs() const noexcept { return m_state->scheduled_recvs; }
     std::size_t scheduled_shared_recvs() const noexcept
@@ -195,12 +201,8 @@ class communicator
     {
         assert(msg);
         auto mrs = m_state->make_multi_request_state(neighs_size);
-        for (std::size_t i = 0; i < neighs_size; ++i)
-        {
-            send(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), neighs[i], tag,
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs](rank_type, tag_type) { --(mrs->m_counter); }), stream);
-        }
+        send_multi(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), neighs, nullptr, tag, mrs,
+            stream);
         return {std::move(mrs)};
     }
 
@@ -217,12 +219,7 @@ class communicator
     {
         assert(msg);
         auto mrs = m_state->make_multi_request_state(neighs_size);
-        for (std::size_t i = 0; i < neighs_size; ++i)
-        {
-            send(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), neighs[i], tags[i],
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs](rank_type, tag_type) { --(mrs->m_counter); }), stream);
-        }
+        send_multi(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), neighs, tags, 0, mrs, stream);
         return {std::move(mrs)};
     }
 
@@ -234,6 +231,35 @@ class communicator
         return send_multi(msg, neighs.data(), tags.data(), neighs.size(), stream);
     }
 
+    // recv_multi
+    // ----------
+
+    // receive msgs[i] from srcs[i] with tags[i]: the request completes once all have arrived
+    template<typename T>
+    recv_multi_request recv_multi(message_buffer<T>* msgs, rank_type const* srcs,
+        tag_type const* tags, std::size_t n, void* stream = nullptr)
+    {
+        auto mrs = m_state->make_multi_request_state(n);
+        if (n > 0ul) mrs->m_self_ptr = mrs;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            assert(msgs[i]);
+            recv(msgs[i].m.m_heap_ptr.get(), msgs[i].size() * sizeof(T), srcs[i], tags[i],
+                util::unique_function<void(rank_type, tag_type)>(
+                    detail::multi_request_callback{mrs.get()}), stream);
+        }
+        return {std::move(mrs)};
+    }
+
+    template<typename T>
+    recv_multi_request recv_multi(std::vector<message_buffer<T>>& msgs,
+        std::vector<rank_type> const& srcs, std::vector<tag_type> const& tags,
+        void* stream = nullptr)
+    {
+        assert(msgs.size() == srcs.size() && msgs.size() == tags.size());
+        return recv_multi(msgs.data(), srcs.data(), tags.data(), msgs.size(), stream);
+    }
+
     // callback versions
     // =================
 
@@ -264,6 +290,44 @@ class communicator
                 cb_lref<T, CallBack>{std::forward<CallBack>(callback), &msg}), stream);
     }
 
+    // recv_multi
+    // ----------
+
+    // callback(msgs[i], srcs[i], tags[i]) is invoked as soon as message i has arrived, so that
+    // it can be consumed while the other messages are still in flight
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_ref_v<CallBack, T>>>
+    recv_multi_request recv_multi(message_buffer<T>* msgs, rank_type const* srcs,
+        tag_type const* tags, std::size_t n, CallBack&& callback, void* stream = nullptr)
+    {
+        auto mrs = m_state->make_multi_request_state(n);
+        if (n > 0ul) mrs->m_self_ptr = mrs;
+        auto cb = util::make_shared<std::decay_t<CallBack>>(std::forward<CallBack>(callback));
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            assert(msgs[i]);
+            recv(msgs[i].m.m_heap_ptr.get(), msgs[i].size() * sizeof(T), srcs[i], tags[i],
+                util::unique_function<void(rank_type, tag_type)>(
+                    [p = mrs.get(), m = msgs + i, cb](rank_type r, tag_type t)
+                    {
+                        (*cb)(*m, r, t);
+                        p->complete_one();
+                    }), stream);
+        }
+        return {std::move(mrs)};
+    }
+
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_ref_v<CallBack, T>>>
+    recv_multi_request recv_multi(std::vector<message_buffer<T>>& msgs,
+        std::vector<rank_type> const& srcs, std::vector<tag_type> const& tags,
+        CallBack&& callback, void* stream = nullptr)
+    {
+        assert(msgs.size() == srcs.size() && msgs.size() == tags.size());
+        return recv_multi(msgs.data(), srcs.data(), tags.data(), msgs.size(),
+            std::forward<CallBack>(callback), stream);
+    }
+
     // shared_recv
     // -----------
 
@@ -293,6 +357,23 @@ class communicator
                 cb_lref<T, CallBack>{std::forward<CallBack>(callback), &msg}), stream);
     }
 
+    // recv_any_size
+    // -------------
+
+    // receive a message of unknown size from src (or any_source) with tag (or any_tag): once the
+    // message has been matched, a buffer of its size is allocated from the heap and passed to the
+    // callback (which owns it) together with the actual source and tag
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_v<CallBack, T>>>
+    recv_request recv_any_size(rank_type src, tag_type tag, CallBack&& callback)
+    {
+        return recv_any_size(src, tag,
+            util::unique_function<void(detail::message_buffer, std::size_t, rank_type, tag_type)>(
+                [cb = std::decay_t<CallBack>(std::forward<CallBack>(callback))](
+                    detail::message_buffer m, std::size_t size, rank_type r, tag_type t) mutable
+                { cb(message_buffer<T>(std::move(m), size / sizeof(T)), r, t); }));
+    }
+
     // send
     // ----
 
@@ -333,6 +414,97 @@ class communicator
                 cb_lref_const<T, CallBack>{std::forward<CallBack>(callback), &msg}), stream);
     }
 
+    // priority lanes
+    // --------------
+
+    // send and recv as above, on the lane of the given priority: a message sent with
+    // priority::high is only matched by a receive posted with priority::high (host memory only)
+
+    template<typename T>
+    recv_request recv(message_buffer<T>& msg, rank_type src, tag_type tag, priority p)
+    {
+        assert(msg);
+        return recv(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), src, tag,
+            util::unique_function<void(rank_type, tag_type)>([](rank_type, tag_type) {}), nullptr,
+            p);
+    }
+
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_v<CallBack, T>>>
+    recv_request recv(message_buffer<T>&& msg, rank_type src, tag_type tag, CallBack&& callback,
+        priority p)
+    {
+        assert(msg);
+        const auto s = msg.size();
+        auto       m_ptr = msg.m.m_heap_ptr.get();
+        return recv(m_ptr, s * sizeof(T), src, tag,
+            util::unique_function<void(rank_type, tag_type)>(
+                cb_rref<T, CallBack>{std::forward<CallBack>(callback), std::move(msg)}),
+            nullptr, p);
+    }
+
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_ref_v<CallBack, T>>>
+    recv_request recv(message_buffer<T>& msg, rank_type src, tag_type tag, CallBack&& callback,
+        priority p)
+    {
+        assert(msg);
+        const auto s = msg.size();
+        auto       m_ptr = msg.m.m_heap_ptr.get();
+        return recv(m_ptr, s * sizeof(T), src, tag,
+            util::unique_function<void(rank_type, tag_type)>(
+                cb_lref<T, CallBack>{std::forward<CallBack>(callback), &msg}), nullptr, p);
+    }
+
+    template<typename T>
+    send_request send(message_buffer<T> const& msg, rank_type dst, tag_type tag, priority p)
+    {
+        assert(msg);
+        return send(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), dst, tag,
+            util::unique_function<void(rank_type, tag_type)>([](rank_type, tag_type) {}), nullptr,
+            p);
+    }
+
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_v<CallBack, T>>>
+    send_request send(message_buffer<T>&& msg, rank_type dst, tag_type tag, CallBack&& callback,
+        priority p)
+    {
+        assert(msg);
+        const auto s = msg.size();
+        auto       m_ptr = msg.m.m_heap_ptr.get();
+        return send(m_ptr, s * sizeof(T), dst, tag,
+            util::unique_function<void(rank_type, tag_type)>(
+                cb_rref<T, CallBack>{std::forward<CallBack>(callback), std::move(msg)}),
+            nullptr, p);
+    }
+
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_ref_v<CallBack, T>>>
+    send_request send(message_buffer<T>& msg, rank_type dst, tag_type tag, CallBack&& callback,
+        priority p)
+    {
+        assert(msg);
+        const auto s = msg.size();
+        auto       m_ptr = msg.m.m_heap_ptr.get();
+        return send(m_ptr, s * sizeof(T), dst, tag,
+            util::unique_function<void(rank_type, tag_type)>(
+                cb_lref<T, CallBack>{std::forward<CallBack>(callback), &msg}), nullptr, p);
+    }
+
+    template<typename T, typename CallBack,
+        typename = std::enable_if_t<detail::is_callback_for_const_ref_v<CallBack, T>>>
+    send_request send(message_buffer<T> const& msg, rank_type dst, tag_type tag,
+        CallBack&& callback, priority p)
+    {
+        assert(msg);
+        const auto s = msg.size();
+        auto       m_ptr = msg.m.m_heap_ptr.get();
+        return send(m_ptr, s * sizeof(T), dst, tag,
+            util::unique_function<void(rank_type, tag_type)>(
+                cb_lref_const<T, CallBack>{std::forward<CallBack>(callback), &msg}), nullptr, p);
+    }
+
     // send_multi
     // ----------
 
@@ -345,19 +517,12 @@ class communicator
         auto const s = msg.size();
         auto       m_ptr = msg.m.m_heap_ptr.get();
         auto       mrs = m_state->make_multi_request_state(std::move(neighs), std::move(msg));
-        for (auto dst : mrs->m_neighs)
+        mrs->m_cb = [p = mrs.get(), callback, tag]()
         {
-            send(m_ptr, s * sizeof(T), dst, tag,
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs, callback](rank_type, tag_type t)
-                    {
-                        if (--(mrs->m_counter) == 0ul)
-                        {
-                            callback(message_buffer<T>(std::move(mrs->m_msg), mrs->m_msg_size),
-                                std::move(mrs->m_neighs), t);
-                        }
-                    }), stream);
-        }
+            callback(message_buffer<T>(std::move(p->m_msg), p->m_msg_size), std::move(p->m_neighs),
+                tag);
+        };
+        send_multi(m_ptr, s * sizeof(T), mrs->m_neighs.data(), nullptr, tag, mrs, stream);
         return {std::move(mrs)};
     }
 
@@ -372,20 +537,12 @@ class communicator
         auto       m_ptr = msg.m.m_heap_ptr.get();
         auto       mrs =
             m_state->make_multi_request_state(std::move(neighs), std::move(tags), std::move(msg));
-        const auto n = mrs->m_neighs.size();
-        for (std::size_t i = 0; i < n; ++i)
+        mrs->m_cb = [p = mrs.get(), callback]()
         {
-            send(m_ptr, s * sizeof(T), mrs->m_neighs[i], mrs->m_tags[i],
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs, callback](rank_type, tag_type)
-                    {
-                        if (--(mrs->m_counter) == 0ul)
-                        {
-                            callback(message_buffer<T>(std::move(mrs->m_msg), mrs->m_msg_size),
-                                std::move(mrs->m_neighs), mrs->m_tags);
-                        }
-                    }), stream);
-        }
+            callback(message_buffer<T>(std::move(p->m_msg), p->m_msg_size), std::move(p->m_neighs),
+                p->m_tags);
+        };
+        send_multi(m_ptr, s * sizeof(T), mrs->m_neighs.data(), mrs->m_tags.data(), 0, mrs, stream);
         return {std::move(mrs)};
     }
 
@@ -398,19 +555,12 @@ class communicator
         auto const s = msg.size();
         auto       m_ptr = msg.m.m_heap_ptr.get();
         auto       mrs = m_state->make_multi_request_state(std::move(neighs), msg);
-        for (auto dst : mrs->m_neighs)
+        mrs->m_cb = [p = mrs.get(), callback, tag]()
         {
-            send(m_ptr, s * sizeof(T), dst, tag,
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs, callback](rank_type, tag_type t)
-                    {
-                        if (--(mrs->m_counter) == 0ul)
-                        {
-                            callback(*reinterpret_cast<message_buffer<T>*>(mrs->m_msg_ptr),
-                                std::move(mrs->m_neighs), t);
-                        }
-                    }), stream);
-        }
+            callback(*reinterpret_cast<message_buffer<T>*>(p->m_msg_ptr), std::move(p->m_neighs),
+                tag);
+        };
+        send_multi(m_ptr, s * sizeof(T), mrs->m_neighs.data(), nullptr, tag, mrs, stream);
         return {std::move(mrs)};
     }
 
@@ -424,20 +574,12 @@ class communicator
         auto const s = msg.size();
         auto       m_ptr = msg.m.m_heap_ptr.get();
         auto       mrs = m_state->make_multi_request_state(std::move(neighs), std::move(tags), msg);
-        const auto n = mrs->m_neighs.size();
-        for (std::size_t i = 0; i < n; ++i)
+        mrs->m_cb = [p = mrs.get(), callback]()
         {
-            send(m_ptr, s * sizeof(T), mrs->m_neighs[i], mrs->m_tags[i],
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs, callback](rank_type, tag_type)
-                    {
-                        if (--(mrs->m_counter) == 0ul)
-                        {
-                            callback(*reinterpret_cast<message_buffer<T>*>(mrs->m_msg_ptr),
-                                std::move(mrs->m_neighs), std::move(mrs->m_tags));
-                        }
-                    }), stream);
-        }
+            callback(*reinterpret_cast<message_buffer<T>*>(p->m_msg_ptr), std::move(p->m_neighs),
+                std::move(p->m_tags));
+        };
+        send_multi(m_ptr, s * sizeof(T), mrs->m_neighs.data(), mrs->m_tags.data(), 0, mrs, stream);
         return {std::move(mrs)};
     }
 
@@ -450,19 +592,12 @@ class communicator
         auto const s = msg.size();
         auto       m_ptr = msg.m.m_heap_ptr.get();
         auto       mrs = m_state->make_multi_request_state(std::move(neighs), msg);
-        for (auto dst : mrs->m_neighs)
+        mrs->m_cb = [p = mrs.get(), callback, tag]()
         {
-            send(m_ptr, s * sizeof(T), dst, tag,
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs, callback](rank_type, tag_type t)
-                    {
-                        if (--(mrs->m_counter) == 0ul)
-                        {
-                            callback(*reinterpret_cast<message_buffer<T> const*>(mrs->m_msg_ptr),
-                                std::move(mrs->m_neighs), t);
-                        }
-                    }), stream);
-        }
+            callback(*reinterpret_cast<message_buffer<T> const*>(p->m_msg_ptr),
+                std::move(p->m_neighs), tag);
+        };
+        send_multi(m_ptr, s * sizeof(T), mrs->m_neighs.data(), nullptr, tag, mrs, stream);
         return {std::move(mrs)};
     }
 
@@ -476,23 +611,137 @@ class communicator
         auto const s = msg.size();
         auto       m_ptr = msg.m.m_heap_ptr.get();
         auto       mrs = m_state->make_multi_request_state(std::move(neighs), std::move(tags), msg);
-        const auto n = mrs->m_neighs.size();
-        for (std::size_t i = 0; i < n; ++i)
+        mrs->m_cb = [p = mrs.get(), callback]()
         {
-            send(m_ptr, s * sizeof(T), mrs->m_neighs[i], mrs->m_tags[i],
-                util::unique_function<void(rank_type, tag_type)>(
-                    [mrs, callback](rank_type, tag_type)
-                    {
-                        if (--(mrs->m_counter) == 0ul)
-                        {
-                            callback(*reinterpret_cast<message_buffer<T> const*>(mrs->m_msg_ptr),
-                                std::move(mrs->m_neighs), std::move(mrs->m_tags));
-                        }
-                    }), stream);
-        }
+            callback(*reinterpret_cast<message_buffer<T> const*>(p->m_msg_ptr),
+                std::move(p->m_neighs), std::move(p->m_tags));
+        };
+        send_multi(m_ptr, s * sizeof(T), mrs->m_neighs.data(), mrs->m_tags.data(), 0, mrs, stream);
         return {std::move(mrs)};
     }
 
+    // recv_stream
+    // -----------
+
+    // keep depth receives of size elements from src (or any_source) with tag posted: callback is
+    // invoked with a recv_lease<T> for every message, see recv_stream
+    template<typename T, typename CallBack>
+    recv_stream<T> make_recv_stream(rank_type src, tag_type tag, std::size_t size,
+        std::size_t depth, CallBack&& callback)
+    {
+        using state_type = detail::recv_stream_state<T>;
+        using cb_type = typename state_type::cb_type;
+        auto s = util::make_shared<state_type>(src, tag,
+            cb_type(std::decay_t<CallBack>(std::forward<CallBack>(callback))),
+            typename state_type::post_type(
+                [cs = m_state](typename state_type::ptr_type const& s, std::size_t i)
+                { communicator{cs}.recv_stream_post(s, i); }));
+        s->m_slots.resize(depth);
+        for (auto& slot : s->m_slots) slot.m_buffer = make_buffer<T>(size);
+        for (std::size_t i = 0; i < depth; ++i) recv_stream_post(s, i);
+        return {std::move(s)};
+    }
+
+    // active messages
+    // ===============
+
+    // handler is invoked from progress for every active message with id sent to this rank (see
+    // am_message); it replaces a previously registered handler. All communicators of a context and
+    // tag range which use active messages must register the same handlers.
+    template<typename Handler>
+    void register_am(am_id id, Handler&& handler)
+    {
+        register_am_handler(id, am_handler(std::decay_t<Handler>(std::forward<Handler>(handler))));
+    }
+
+    // send an active message: the header is copied and limited by the eager size, the payload is
+    // read from host memory and must not be modified until the request has completed
+    template<typename T>
+    send_request send_am(rank_type dst, am_id id, void const* header, std::size_t header_size,
+        message_buffer<T> const& payload)
+    {
+        assert(payload);
+        return send_am(dst, id, header, header_size, payload.m.m_heap_ptr.get(),
+            payload.size() * sizeof(T));
+    }
+
+    send_request send_am(rank_type dst, am_id id, void const* header, std::size_t header_size)
+    {
+        return send_am(dst, id, header, header_size, nullptr, 0u);
+    }
+
+    // collectives
+    // ===========
+
+    // nonblocking allreduce over all ranks; msg holds the local contribution and receives the
+    // result. msg must stay alive until the request has completed, and concurrent allreduce
+    // operations must use distinct tags.
+    template<typename T>
+    allreduce_request allreduce(message_buffer<T>& msg, reduce_op op, tag_type tag)
+    {
+        assert(msg);
+        auto const n = size();
+        rank_type  pof2 = 1;
+        while (2 * pof2 <= n) pof2 *= 2;
+        auto req = m_state->make_multi_request_state(1u);
+        auto s = util::make_shared<detail::allreduce_state<T>>(&msg, make_buffer<T>(msg.size()),
+            op, tag, pof2, req);
+        auto const r = rank();
+        if (r >= pof2)
+        {
+            s->m_phase = detail::allreduce_state<T>::phase::extra;
+            allreduce_post(s, r - pof2, true, true);
+        }
+        else if (r < n - pof2)
+        {
+            s->m_phase = detail::allreduce_state<T>::phase::fold_in;
+            allreduce_post(s, r + pof2, true, false);
+        }
+        else
+            allreduce_next(s);
+        return {std::move(req)};
+    }
+
+    // one-sided communication
+    // =======================
+
+    // register a message buffer for remote access: msg must outlive the returned object (the MPI
+    // backend needs OOMPH_MPI_RMA=1, see rma_context)
+    template<typename T>
+    exposed_buffer expose(message_buffer<T>& msg)
+    {
+        assert(msg);
+        return expose(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T));
+    }
+
+    // create a handle to remote memory from a descriptor obtained from the peer
+    remote_buffer attach(rma_descriptor const& d);
+
+    // exchange descriptors with peer (must be called symmetrically) and attach to the peer's memory
+    remote_buffer exchange(exposed_buffer const& local, rank_type peer, tag_type tag);
+
+    // write msg to dst at offset (in units of T); the request completes locally
+    template<typename T>
+    rma_request put(message_buffer<T> const& msg, remote_buffer const& dst, std::size_t offset = 0)
+    {
+        assert(msg);
+        assert((offset + msg.size()) * sizeof(T) <= dst.size());
+        return put(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), dst, offset * sizeof(T));
+    }
+
+    // read from src at offset (in units of T) into msg
+    template<typename T>
+    rma_request get(message_buffer<T>& msg, remote_buffer const& src, std::size_t offset = 0)
+    {
+        assert(msg);
+        assert((offset + msg.size()) * sizeof(T) <= src.size());
+        return get(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), src, offset * sizeof(T));
+    }
+
+    // complete all puts issued to the target of dst remotely; a notification sent afterwards
+    // guarantees that the data is visible at the target
+    void flush(remote_buffer const& dst);
+
     void progress();
 
   private:
@@ -506,13 +755,119 @@ class communicator
 #endif
 
     send_request send(detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size,
-        rank_type dst, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream);
+        rank_type dst, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream,
+        priority p = priority::normal);
 
     recv_request recv(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size, rank_type src,
-        tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream);
+        tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream,
+        priority p = priority::normal);
 
     shared_recv_request shared_recv(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size,
         rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream);
+
+    // send to all neighbors (with tags[i], or tag if tags is null), completing mrs once
+    void send_multi(detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size,
+        rank_type const* neighs, tag_type const* tags, tag_type tag,
+        util::unsafe_shared_ptr<detail::multi_request_state> const& mrs, void* stream);
+
+    recv_request recv_any_size(rank_type src, tag_type tag,
+        util::unique_function<void(detail::message_buffer, std::size_t, rank_type, tag_type)>&& cb);
+
+    exposed_buffer expose(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size);
+
+    void register_am_handler(am_id id, am_handler&& handler);
+
+    send_request send_am(rank_type dst, am_id id, void const* header, std::size_t header_size,
+        detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size);
+
+    rma_request put(detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size,
+        remote_buffer const& dst, std::size_t offset);
+
+    rma_request get(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size,
+        remote_buffer const& src, std::size_t offset);
+
+    // post the receive of a slot of a recv_stream
+    template<typename T>
+    void recv_stream_post(util::unsafe_shared_ptr<detail::recv_stream_state<T>> const& s,
+        std::size_t i)
+    {
+        ++s->m_posted;
+        s->m_slots[i].post(
+            [this, &s, i](message_buffer<T>& msg)
+            {
+                return recv(msg.m.m_heap_ptr.get(), msg.size() * sizeof(T), s->m_src, s->m_tag,
+                    util::unique_function<void(rank_type, tag_type)>(
+                        [s, i](rank_type r, tag_type t) { s->deliver(s, i, r, t); }),
+                    nullptr);
+            });
+    }
+
+    // post the receive into the scratch buffer and/or the send of the partial result of a step
+    template<typename T>
+    void allreduce_post(util::unsafe_shared_ptr<detail::allreduce_state<T>> const& s,
+        rank_type peer, bool do_recv, bool do_send)
+    {
+        // the callbacks may run right away: the state must not be touched after the last post
+        s->m_pending = (do_recv ? 1 : 0) + (do_send ? 1 : 0);
+        auto const bytes = s->m_msg->size() * sizeof(T);
+        auto       make_cb = [this, &s]()
+        {
+            return util::unique_function<void(rank_type, tag_type)>(
+                [cs = m_state, s](rank_type, tag_type)
+                {
+                    if (--(s->m_pending) == 0) communicator{cs}.allreduce_done(s);
+                });
+        };
+        if (do_recv)
+            recv(s->m_tmp.m.m_heap_ptr.get(), bytes, peer, s->m_tag, make_cb(), nullptr);
+        if (do_send) send(s->m_msg->m.m_heap_ptr.get(), bytes, peer, s->m_tag, make_cb(), nullptr);
+    }
+
+    // start the next exchange round, or the final step
+    template<typename T>
+    void allreduce_next(util::unsafe_shared_ptr<detail::allreduce_state<T>> const& s)
+    {
+        using phase = typename detail::allreduce_state<T>::phase;
+        auto const r = rank();
+        if (s->m_mask < s->m_pof2)
+        {
+            s->m_phase = phase::exchange;
+            allreduce_post(s, r ^ s->m_mask, true, true);
+        }
+        else if (r < size() - s->m_pof2)
+        {
+            s->m_phase = phase::fold_out;
+            allreduce_post(s, r + s->m_pof2, false, true);
+        }
+        else
+            s->finish();
+    }
+
+    // all operations of the current step have completed
+    template<typename T>
+    void allreduce_done(util::unsafe_shared_ptr<detail::allreduce_state<T>> const& s)
+    {
+        using phase = typename detail::allreduce_state<T>::phase;
+        switch (s->m_phase)
+        {
+        case phase::extra:
+            std::copy(s->m_tmp.begin(), s->m_tmp.end(), s->m_msg->begin());
+            s->finish();
+            break;
+        case phase::fold_in:
+            s->combine();
+            allreduce_next(s);
+            break;
+        case phase::exchange:
+            s->combine();
+            s->m_mask *= 2;
+            allreduce_next(s);
+            break;
+        case phase::fold_out:
+            s->finish();
+            break;
+        }
+    }
 };
 
 } // namespace oomph
@@ -17,6 +17,7 @@
 #include <oomph/communicator.hpp>
 #include <oomph/util/mpi_comm_holder.hpp>
 #include <oomph/util/heap_pimpl.hpp>
+#include <oomph/util/tag_range.hpp>
 
 namespace oomph
 {
@@ -40,11 +41,17 @@ class context
     util::mpi_comm_holder     m_mpi_comm;
     pimpl                     m;
     std::unique_ptr<schedule> m_schedule;
+    util::tag_range_factory   m_tag_range_factory;
 
   public:
     context(MPI_Comm comm, bool thread_safe = true,
         hwmalloc::heap_config const& = hwmalloc::get_default_heap_config());
 
+    // partition the tag space into num_tag_ranges disjoint ranges: communicators obtained from
+    // different ranges never match each other's messages
+    context(MPI_Comm comm, bool thread_safe, unsigned int num_tag_ranges,
+        hwmalloc::heap_config const& = hwmalloc::get_default_heap_config());
+
     context(context const&) = delete;
 
     context(context&&) noexcept = default;
@@ -100,9 +107,9 @@ class context
     }
 #endif
 
-    communicator get_communicator(); //unsigned int tag_range = 0);
+    communicator get_communicator(unsigned int tag_range = 0);
 
-    //unsigned int num_tag_ranges() const noexcept { return m_tag_range_factory.num_ranges(); }
+    unsigned int num_tag_ranges() const noexcept { return m_tag_range_factory.num_ranges(); }
 
     const char* get_transport_option(const std::string& opt) const;
 
@@ -0,0 +1,82 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+
+#include <oomph/message_buffer.hpp>
+#include <oomph/request.hpp>
+#include <oomph/types.hpp>
+#include <oomph/util/unsafe_shared_ptr.hpp>
+
+namespace oomph
+{
+enum class reduce_op
+{
+    sum,
+    min,
+    max
+};
+
+namespace detail
+{
+// State of one recursive doubling allreduce. With p the largest power of two not larger than the
+// number of ranks, ranks r >= p first fold their data into rank r - p and receive the result at
+// the end, while ranks r < p exchange and combine their partial results with rank r ^ mask for
+// mask = 1, 2, ..., p/2.
+template<typename T>
+struct allreduce_state
+{
+    static_assert(std::is_trivially_copyable<T>::value, "allreduce requires a POD value type");
+
+    enum class phase
+    {
+        fold_in,
+        exchange,
+        fold_out,
+        extra
+    };
+
+    oomph::message_buffer<T>*                    m_msg;
+    oomph::message_buffer<T>                     m_tmp;
+    reduce_op                                    m_op;
+    tag_type                                     m_tag;
+    rank_type                                    m_pof2;
+    util::unsafe_shared_ptr<multi_request_state> m_req;
+    phase                                        m_phase = phase::exchange;
+    rank_type                                    m_mask = 1;
+    int                                          m_pending = 0;
+
+    // m_msg = m_msg op m_tmp
+    void combine()
+    {
+        auto       x = m_msg->data();
+        auto const y = m_tmp.data();
+        auto const n = m_msg->size();
+        switch (m_op)
+        {
+        case reduce_op::sum:
+            for (std::size_t i = 0; i < n; ++i) x[i] += y[i];
+            break;
+        case reduce_op::min:
+            for (std::size_t i = 0; i < n; ++i) x[i] = std::min(x[i], y[i]);
+            break;
+        case reduce_op::max:
+            for (std::size_t i = 0; i < n; ++i) x[i] = std::max(x[i], y[i]);
+            break;
+        }
+    }
+
+    void finish() { m_req->m_counter = 0; }
+};
+
+} // namespace detail
+} // namespace oomph
@@ -0,0 +1,43 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <oomph/request.hpp>
+
+namespace oomph
+{
+namespace detail
+{
+// A receive buffer which is posted again whenever its message has been delivered (recv_stream,
+// active messages, flow control). The callback of the receive may run before the request is
+// returned, and post the slot again: the request is then stale and must not replace the one of
+// the new receive, which is what the sequence number detects.
+template<typename Buffer>
+struct recv_slot
+{
+    Buffer       m_buffer;
+    recv_request m_req;
+    // incremented whenever the slot is posted
+    std::size_t m_seq = 0u;
+
+    // recv(m_buffer) posts the receive and returns its request
+    template<typename Recv>
+    void post(Recv&& recv)
+    {
+        auto const seq = ++m_seq;
+        auto       req = std::forward<Recv>(recv)(m_buffer);
+        if (m_seq == seq) m_req = std::move(req);
+    }
+};
+
+} // namespace detail
+} // namespace oomph
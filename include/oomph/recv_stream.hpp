@@ -0,0 +1,211 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <oomph/message_buffer.hpp>
+#include <oomph/request.hpp>
+#include <oomph/types.hpp>
+#include <oomph/detail/recv_slot.hpp>
+#include <oomph/util/unique_function.hpp>
+#include <oomph/util/unsafe_shared_ptr.hpp>
+
+namespace oomph
+{
+namespace detail
+{
+template<typename T>
+struct recv_stream_state;
+} // namespace detail
+
+// A received message of a recv_stream. The buffer belongs to the stream: it is posted again as soon
+// as the lease is released (explicitly, or when it goes out of scope), so it may be kept beyond the
+// consumer callback, but must be released on the thread of the communicator.
+template<typename T>
+class recv_lease
+{
+    friend struct detail::recv_stream_state<T>;
+
+  private:
+    using state_type = detail::recv_stream_state<T>;
+
+    util::unsafe_shared_ptr<state_type> m_state;
+    std::size_t                         m_slot = 0u;
+    message_buffer<T>                   m_msg;
+    rank_type                           m_src = -1;
+    tag_type                            m_tag = -1;
+
+    recv_lease(util::unsafe_shared_ptr<state_type> s, std::size_t slot, message_buffer<T>&& msg,
+        rank_type src, tag_type tag)
+    : m_state{std::move(s)}
+    , m_slot{slot}
+    , m_msg{std::move(msg)}
+    , m_src{src}
+    , m_tag{tag}
+    {
+    }
+
+  public:
+    recv_lease() = default;
+    recv_lease(recv_lease const&) = delete;
+    recv_lease(recv_lease&&) = default;
+    recv_lease& operator=(recv_lease const&) = delete;
+    recv_lease& operator=(recv_lease&& other)
+    {
+        release();
+        m_state = std::move(other.m_state);
+        m_slot = other.m_slot;
+        m_msg = std::move(other.m_msg);
+        m_src = other.m_src;
+        m_tag = other.m_tag;
+        return *this;
+    }
+    ~recv_lease() { release(); }
+
+  public:
+    operator bool() const noexcept { return (bool)m_state; }
+
+    rank_type src() const noexcept { return m_src; }
+    tag_type  tag() const noexcept { return m_tag; }
+
+    message_buffer<T>&       get() noexcept { return m_msg; }
+    message_buffer<T> const& get() const noexcept { return m_msg; }
+    message_buffer<T>&       operator*() noexcept { return m_msg; }
+    message_buffer<T>*       operator->() noexcept { return &m_msg; }
+
+    // hand the buffer back to the stream
+    void release()
+    {
+        if (!m_state) return;
+        auto s = std::move(m_state);
+        s->release(s, m_slot, std::move(m_msg));
+    }
+};
+
+namespace detail
+{
+// State of a recv_stream: a fixed set of buffers (slots), each of which is either posted, or leased
+// to the consumer. The receive callbacks and the leases keep the state alive, so that it outlives
+// the stream handle while operations are pending.
+template<typename T>
+struct recv_stream_state
+{
+    using ptr_type = util::unsafe_shared_ptr<recv_stream_state>;
+    using cb_type = util::unique_function<void(recv_lease<T>)>;
+    using post_type = util::unique_function<void(ptr_type const&, std::size_t)>;
+    using slot = recv_slot<oomph::message_buffer<T>>;
+
+    rank_type         m_src;
+    tag_type          m_tag;
+    cb_type           m_cb;
+    post_type         m_post;
+    std::vector<slot> m_slots;
+    std::size_t       m_posted = 0u;
+    std::size_t       m_received = 0u;
+    bool              m_closed = false;
+
+    recv_stream_state(rank_type src, tag_type tag, cb_type&& cb, post_type&& post)
+    : m_src{src}
+    , m_tag{tag}
+    , m_cb{std::move(cb)}
+    , m_post{std::move(post)}
+    {
+    }
+
+    // a posted receive has completed
+    void deliver(ptr_type const& self, std::size_t i, rank_type src, tag_type tag)
+    {
+        --m_posted;
+        ++m_received;
+        // messages which arrive after the stream was closed are dropped
+        if (m_closed) return;
+        m_cb(recv_lease<T>(self, i, std::move(m_slots[i].m_buffer), src, tag));
+    }
+
+    void release(ptr_type const& self, std::size_t i, oomph::message_buffer<T>&& msg)
+    {
+        m_slots[i].m_buffer = std::move(msg);
+        if (!m_closed) m_post(self, i);
+    }
+
+    void close()
+    {
+        if (m_closed) return;
+        m_closed = true;
+        // dropping the requests releases the callbacks, and with them the references to this
+        // state; receives which cannot be canceled any more complete on their own
+        for (auto& s : m_slots)
+        {
+            if (s.m_req.cancel()) --m_posted;
+            s.m_req = recv_request();
+        }
+    }
+};
+} // namespace detail
+
+// A set of depth receives from one source (or any_source) and tag which are kept posted: each
+// received message is handed to the consumer callback as a recv_lease, and its buffer is posted
+// again when the lease is released. The buffers are allocated once, when the stream is created
+// with communicator::make_recv_stream, and messages must fit into them. The posted receives count
+// as scheduled receives of the communicator, i.e. communicator::wait_all does not return while the
+// stream is open. The stream is closed when it goes out of scope: its pending receives are canceled
+// (if the transport supports it), and messages which are still received are dropped.
+template<typename T>
+class recv_stream
+{
+    friend class communicator;
+
+  private:
+    using state_type = detail::recv_stream_state<T>;
+
+    util::unsafe_shared_ptr<state_type> m;
+
+    recv_stream(util::unsafe_shared_ptr<state_type> s) noexcept
+    : m{std::move(s)}
+    {
+    }
+
+  public:
+    recv_stream() = default;
+    recv_stream(recv_stream const&) = delete;
+    recv_stream(recv_stream&&) = default;
+    recv_stream& operator=(recv_stream const&) = delete;
+    recv_stream& operator=(recv_stream&& other)
+    {
+        close();
+        m = std::move(other.m);
+        return *this;
+    }
+    ~recv_stream() { close(); }
+
+  public:
+    operator bool() const noexcept { return (bool)m; }
+
+    rank_type src() const noexcept { return m->m_src; }
+    tag_type  tag() const noexcept { return m->m_tag; }
+
+    // number of buffers
+    std::size_t depth() const noexcept { return m->m_slots.size(); }
+
+    // number of currently posted receives
+    std::size_t posted() const noexcept { return m->m_posted; }
+
+    // number of messages received so far
+    std::size_t received() const noexcept { return m->m_received; }
+
+    void close()
+    {
+        if (m) m->close();
+    }
+};
+
+} // namespace oomph
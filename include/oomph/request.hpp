@@ -12,12 +12,15 @@
 #include <memory>
 #include <vector>
 #include <oomph/detail/message_buffer.hpp>
+#include <oomph/util/unique_function.hpp>
 #include <oomph/util/unsafe_shared_ptr.hpp>
 
 namespace oomph
 {
 
 class communicator_impl;
+template<typename Communicator>
+class communicator_base;
 
 namespace detail
 {
@@ -34,6 +37,29 @@ struct multi_request_state
     std::size_t                   m_msg_size = 0ul;
     void*                         m_msg_ptr = nullptr;
     oomph::detail::message_buffer m_msg = oomph::detail::message_buffer();
+    // invoked once, when the last operation has completed
+    util::unique_function<void()> m_cb = util::unique_function<void()>();
+    // keeps the state alive while operations are pending
+    util::unsafe_shared_ptr<multi_request_state> m_self_ptr =
+        util::unsafe_shared_ptr<multi_request_state>();
+
+    void complete_one()
+    {
+        if (--m_counter == 0ul)
+        {
+            auto self = std::move(m_self_ptr);
+            if (m_cb) m_cb();
+        }
+    }
+};
+
+// completion callback of a single operation of a multi request: holds a raw pointer only, so it
+// fits into the small buffer of the unique_function
+struct multi_request_callback
+{
+    multi_request_state* m;
+
+    void operator()(rank_type, tag_type) { m->complete_one(); }
 };
 } // namespace detail
 
@@ -43,6 +69,8 @@ class send_request
     using state_type = detail::request_state;
     friend class communicator;
     friend class communicator_impl;
+    template<typename>
+    friend class communicator_base;
 
     util::unsafe_shared_ptr<state_type> m;
 
@@ -70,6 +98,8 @@ class recv_request
     using state_type = detail::request_state;
     friend class communicator;
     friend class communicator_impl;
+    template<typename>
+    friend class communicator_base;
 
     util::unsafe_shared_ptr<state_type> m;
 
@@ -99,6 +129,8 @@ class shared_recv_request
     using state_type = detail::shared_request_state;
     friend class communicator;
     friend class communicator_impl;
+    template<typename>
+    friend class communicator_base;
 
   private:
     std::shared_ptr<state_type> m;
@@ -123,19 +155,74 @@ class shared_recv_request
     bool cancel();
 };
 
-class send_multi_request
+class rma_request
 {
   protected:
-    using state_type = detail::multi_request_state;
+    using state_type = detail::request_state;
     friend class communicator;
     friend class communicator_impl;
 
     util::unsafe_shared_ptr<state_type> m;
 
-    send_multi_request(util::unsafe_shared_ptr<state_type> s) noexcept
+    rma_request(util::unsafe_shared_ptr<state_type> s) noexcept
+    : m{std::move(s)}
+    {
+    }
+
+  public:
+    rma_request() = default;
+    rma_request(rma_request const&) = delete;
+    rma_request(rma_request&&) = default;
+    rma_request& operator=(rma_request const&) = delete;
+    rma_request& operator=(rma_request&&) = default;
+
+  public:
+    // local completion: the origin buffer may be reused (put) or read (get)
+    bool is_ready() const noexcept;
+    bool test();
+    void wait();
+};
+
+namespace detail
+{
+// Completes when all of a set of operations have completed: the common part of the requests of
+// send_multi, recv_multi and allreduce
+class multi_request
+{
+  protected:
+    using state_type = multi_request_state;
+
+    util::unsafe_shared_ptr<state_type> m;
+
+    multi_request() = default;
+    multi_request(util::unsafe_shared_ptr<state_type> s) noexcept
     : m{std::move(s)}
     {
     }
+    multi_request(multi_request const&) = delete;
+    multi_request(multi_request&&) = default;
+    multi_request& operator=(multi_request const&) = delete;
+    multi_request& operator=(multi_request&&) = default;
+    ~multi_request() = default;
+
+  public:
+    bool is_ready() const noexcept;
+    bool test();
+    void wait();
+};
+} // namespace detail
+
+// completes when the message has been sent to all neighbors
+class send_multi_request : public detail::multi_request
+{
+  protected:
+    friend class communicator;
+    friend class communicator_impl;
+
+    send_multi_request(util::unsafe_shared_ptr<state_type> s) noexcept
+    : detail::multi_request{std::move(s)}
+    {
+    }
 
   public:
     send_multi_request() = default;
@@ -143,11 +230,46 @@ class send_multi_request
     send_multi_request(send_multi_request&&) = default;
     send_multi_request& operator=(send_multi_request const&) = delete;
     send_multi_request& operator=(send_multi_request&&) = default;
+};
+
+// completes when all messages have been received
+class recv_multi_request : public detail::multi_request
+{
+  protected:
+    friend class communicator;
+    friend class communicator_impl;
+
+    recv_multi_request(util::unsafe_shared_ptr<state_type> s) noexcept
+    : detail::multi_request{std::move(s)}
+    {
+    }
 
   public:
-    bool is_ready() const noexcept;
-    bool test();
-    void wait();
+    recv_multi_request() = default;
+    recv_multi_request(recv_multi_request const&) = delete;
+    recv_multi_request(recv_multi_request&&) = default;
+    recv_multi_request& operator=(recv_multi_request const&) = delete;
+    recv_multi_request& operator=(recv_multi_request&&) = default;
+};
+
+// completes when the result of the reduction is available
+class allreduce_request : public detail::multi_request
+{
+  protected:
+    friend class communicator;
+    friend class communicator_impl;
+
+    allreduce_request(util::unsafe_shared_ptr<state_type> s) noexcept
+    : detail::multi_request{std::move(s)}
+    {
+    }
+
+  public:
+    allreduce_request() = default;
+    allreduce_request(allreduce_request const&) = delete;
+    allreduce_request(allreduce_request&&) = default;
+    allreduce_request& operator=(allreduce_request const&) = delete;
+    allreduce_request& operator=(allreduce_request&&) = default;
 };
 
 } // namespace oomph
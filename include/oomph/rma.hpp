@@ -0,0 +1,94 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <oomph/types.hpp>
+#include <oomph/util/heap_pimpl.hpp>
+
+namespace oomph
+{
+class exposed_buffer_impl;
+class remote_buffer_impl;
+
+// Trivially copyable description of a remotely accessible memory region. It is produced by the
+// owner of the memory (see exposed_buffer) and must be shipped to the peers which want to access
+// it, e.g. with communicator::exchange or any other means (plain send/recv, MPI, ...).
+struct rma_descriptor
+{
+    static constexpr std::size_t max_key_size = 512;
+
+    rank_type     m_rank = -1;
+    std::uint64_t m_address = 0u;
+    std::size_t   m_size = 0u;
+    std::uint32_t m_key_size = 0u;
+    unsigned char m_key[max_key_size];
+};
+
+// Registration of a local message buffer for remote access. The buffer must outlive this object.
+class exposed_buffer
+{
+    friend class communicator;
+
+  private:
+    util::heap_pimpl<exposed_buffer_impl> m_impl;
+    rma_descriptor                        m_descriptor;
+
+    exposed_buffer(exposed_buffer_impl* impl, rma_descriptor const& d);
+
+  public:
+    exposed_buffer();
+    exposed_buffer(exposed_buffer const&) = delete;
+    exposed_buffer(exposed_buffer&&) noexcept;
+    exposed_buffer& operator=(exposed_buffer const&) = delete;
+    exposed_buffer& operator=(exposed_buffer&&) noexcept;
+    ~exposed_buffer();
+
+  public:
+    operator bool() const noexcept { return m_descriptor.m_rank >= 0; }
+
+    rma_descriptor const& descriptor() const noexcept { return m_descriptor; }
+
+    // size in bytes
+    std::size_t size() const noexcept { return m_descriptor.m_size; }
+};
+
+// Handle to a peer's exposed buffer. It is bound to the communicator which created it and can only
+// be used as target (put) or source (get) of one-sided operations issued on that communicator.
+class remote_buffer
+{
+    friend class communicator;
+
+  private:
+    util::heap_pimpl<remote_buffer_impl> m_impl;
+    rank_type                            m_rank = -1;
+    std::size_t                          m_size = 0u;
+
+    remote_buffer(remote_buffer_impl* impl, rank_type rank, std::size_t size);
+
+  public:
+    remote_buffer();
+    remote_buffer(remote_buffer const&) = delete;
+    remote_buffer(remote_buffer&&) noexcept;
+    remote_buffer& operator=(remote_buffer const&) = delete;
+    remote_buffer& operator=(remote_buffer&&) noexcept;
+    ~remote_buffer();
+
+  public:
+    operator bool() const noexcept { return m_rank >= 0; }
+
+    rank_type rank() const noexcept { return m_rank; }
+
+    // size in bytes
+    std::size_t size() const noexcept { return m_size; }
+};
+
+} // namespace oomph
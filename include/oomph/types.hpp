@@ -15,4 +15,13 @@ namespace oomph
 using tag_type = int;
 using rank_type = int;
 
+// Lane of a point-to-point message. High priority messages are meant for small, latency critical
+// traffic: backends which support it match them separately from the normal traffic and progress
+// them first. Like the tag, the priority of a send and of the matching receive must agree.
+enum class priority
+{
+    normal,
+    high
+};
+
 } // namespace oomph
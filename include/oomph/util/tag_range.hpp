@@ -0,0 +1,101 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <oomph/types.hpp>
+
+namespace oomph
+{
+namespace util
+{
+// A contiguous, disjoint sub-space of the tags supported by the transport. User tags in
+// [0, max_tag()] are shifted into the range right before they hit the wire. The messages of the
+// library itself use the same range on a separate matching space (see internal_tag).
+class tag_range
+{
+  private:
+    tag_type     m_offset = 0;
+    tag_type     m_max_tag = std::numeric_limits<tag_type>::max();
+    unsigned int m_index = 0u;
+    unsigned int m_num_ranges = 1u;
+
+  public:
+    tag_range() noexcept = default;
+
+    tag_range(tag_type offset, tag_type max_tag, unsigned int index = 0u,
+        unsigned int num_ranges = 1u) noexcept
+    : m_offset{offset}
+    , m_max_tag{max_tag}
+    , m_index{index}
+    , m_num_ranges{num_ranges}
+    {
+    }
+
+    unsigned int index() const noexcept { return m_index; }
+    // number of ranges the tag space is split into
+    unsigned int num_ranges() const noexcept { return m_num_ranges; }
+    tag_type     offset() const noexcept { return m_offset; }
+    tag_type     max_tag() const noexcept { return m_max_tag; }
+
+    // throws unless tag is a user tag in [0, max_tag()], or any_tag (-1) if wildcards are allowed
+    void check(tag_type tag, bool wildcard) const
+    {
+        if ((tag >= 0 && tag <= m_max_tag) || (wildcard && tag == -1)) return;
+        throw std::runtime_error("oomph: tag " + std::to_string(tag) + " is not in [0, " +
+                                 std::to_string(m_max_tag) + "]");
+    }
+
+    // wire tag for a user tag (negative wildcard tags are passed through)
+    tag_type map(tag_type tag) const noexcept
+    {
+        assert(tag <= m_max_tag);
+        return tag < 0 ? tag : m_offset + tag;
+    }
+};
+
+// Splits the tag space of the transport into num_ranges ranges of equal size. The range index is
+// stored in the most significant tag bits. With zero ranges, the whole tag space is handed out as
+// a single range.
+class tag_range_factory
+{
+  private:
+    unsigned int m_num_ranges;
+    unsigned int m_range_shift;
+
+  public:
+    tag_range_factory(unsigned int num_ranges, unsigned int num_tag_bits)
+    : m_num_ranges{num_ranges}
+    , m_range_shift{num_tag_bits < 31u ? num_tag_bits : 31u}
+    {
+        unsigned int range_bits = 0u;
+        while ((1u << range_bits) < m_num_ranges) ++range_bits;
+        if (range_bits >= m_range_shift)
+            throw std::runtime_error("oomph: too many tag ranges for the available tag bits");
+        m_range_shift -= range_bits;
+    }
+
+    unsigned int num_ranges() const noexcept { return m_num_ranges; }
+
+    tag_range create(unsigned int range) const
+    {
+        if (range >= std::max(m_num_ranges, 1u))
+            throw std::out_of_range("oomph: tag range index out of range");
+        return {(tag_type)(range << m_range_shift), (tag_type)((1u << m_range_shift) - 1u), range,
+            std::max(m_num_ranges, 1u)};
+    }
+};
+
+} // namespace util
+} // namespace oomph
@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <typeinfo>
 #include <type_traits>
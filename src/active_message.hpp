@@ -0,0 +1,331 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <hwmalloc/numa.hpp>
+#include <oomph/active_message.hpp>
+#include <oomph/communicator.hpp>
+#include <oomph/detail/recv_slot.hpp>
+#include <oomph/request.hpp>
+#include <../internal_tags.hpp>
+
+namespace oomph
+{
+// ----------------------------------------
+// size of the eager active message buffers
+// ----------------------------------------
+static std::size_t
+am_eager_size()
+{
+    auto env_str = std::getenv("OOMPH_AM_EAGER_SIZE");
+    if (env_str != nullptr)
+    {
+        char* end;
+        return std::strtoull(env_str, &end, 0);
+    }
+    return 8192u;
+}
+
+// ----------------------------------------
+// number of posted eager receives
+// ----------------------------------------
+static std::size_t
+am_depth()
+{
+    auto env_str = std::getenv("OOMPH_AM_DEPTH");
+    if (env_str != nullptr)
+    {
+        char* end;
+        return std::strtoull(env_str, &end, 0);
+    }
+    return 16u;
+}
+
+// Active messages on top of the internal lane of a communicator (see internal_tag), so that they
+// are never matched by receives of the user. Every message starts with a packet (packet header,
+// user header and, if everything fits into the eager size, the payload) which is sent with the
+// packet tag to one of the depth eager receives from any source. Handlers of eager messages are
+// invoked with pointers into the receive buffer, which is posted again afterwards. Larger payloads
+// are sent separately, with a payload tag which the sender takes in turn from the tags of the tag
+// range above the packet and credit tags, and which the packet announces: the receiver posts a
+// receive of the exact size with this tag once it has seen the packet. The payload tags are
+// numbered per context, so payloads are told apart as long as fewer than max_tag - 1 of them are
+// in flight from one rank. Messages to self are queued and delivered by progress.
+//
+// Every communicator has an engine of its own, whose eager receives are posted when the first
+// handler is registered. The engines of the communicators of a context and tag range share the
+// packet tag, so a message is delivered to whichever of them matches it first, just like a
+// message of the user: they must all register the same handlers.
+//
+// Configured through the environment (identically on all ranks):
+//   OOMPH_AM_EAGER_SIZE=<n>    size of the eager buffers in bytes (default: 8192)
+//   OOMPH_AM_DEPTH=<n>         number of posted eager receives (default: 16)
+template<typename Communicator>
+class am_engine
+{
+  private:
+    using heap_type = std::remove_reference_t<decltype(std::declval<Communicator&>().get_heap())>;
+    using pointer = typename heap_type::pointer;
+    using cb_type = util::unique_function<void(rank_type, tag_type)>;
+
+    // start of every packet: receives from any source do not report the actual source
+    struct packet
+    {
+        std::uint32_t m_id;
+        std::int32_t  m_src;
+        std::int32_t  m_payload_tag; // of a rendezvous message, -1 for an eager message
+        std::uint32_t m_reserved;
+        std::uint64_t m_header_size;
+        std::uint64_t m_payload_size;
+    };
+
+    using slot = detail::recv_slot<pointer>;
+
+    struct payload_recv
+    {
+        rank_type         m_src;
+        am_id             m_id;
+        std::vector<char> m_header;
+        std::size_t       m_payload_size;
+        pointer           m_ptr;
+        recv_request      m_req;
+        bool              m_posting = true;
+        bool              m_done = false;
+    };
+
+    struct self_message
+    {
+        am_id             m_id;
+        std::vector<char> m_header;
+        std::vector<char> m_payload;
+    };
+
+  private:
+    Communicator*                         m_comm;
+    std::size_t const                     m_eager_size;
+    std::size_t const                     m_depth;
+    std::unordered_map<am_id, am_handler> m_handlers;
+    std::vector<slot>                     m_slots;
+    std::vector<pointer>                  m_send_buffers;
+    std::vector<std::size_t>              m_free_send_buffers;
+    std::list<payload_recv>               m_payload_recvs;
+    std::deque<self_message>              m_self;
+    std::deque<self_message>              m_self_work;
+    std::size_t                           m_scheduled = 0u;
+    bool                                  m_closed = false;
+
+  public:
+    am_engine(Communicator* comm)
+    : m_comm{comm}
+    , m_eager_size{am_eager_size()}
+    , m_depth{am_depth()}
+    {
+        if (m_eager_size < sizeof(packet))
+            throw std::runtime_error("oomph: OOMPH_AM_EAGER_SIZE is too small");
+        if (m_comm->tag_range().max_tag() < internal_tag::am_payload)
+            throw std::runtime_error("oomph: the tag range is too small for active messages");
+    }
+
+    am_engine(am_engine const&) = delete;
+
+    ~am_engine()
+    {
+        close();
+        for (auto& s : m_slots) s.m_buffer.release();
+        for (auto& p : m_send_buffers) p.release();
+    }
+
+  public:
+    void register_handler(am_id id, am_handler&& h)
+    {
+        m_handlers[id] = std::move(h);
+        if (!m_slots.empty()) return;
+        m_slots.resize(m_depth);
+        for (auto& s : m_slots) s.m_buffer = allocate(m_eager_size);
+        for (std::size_t i = 0; i < m_depth; ++i) post(i);
+    }
+
+    send_request send(rank_type dst, am_id id, void const* header, std::size_t header_size,
+        pointer const* payload, std::size_t payload_size, std::size_t* scheduled)
+    {
+        if (sizeof(packet) + header_size > m_eager_size)
+            throw std::runtime_error("oomph: active message header exceeds OOMPH_AM_EAGER_SIZE");
+        auto const payload_ptr = payload ? payload->get() : nullptr;
+        if (dst == m_comm->rank())
+        {
+            auto const h = static_cast<char const*>(header);
+            auto const p = static_cast<char const*>(payload_ptr);
+            m_self.push_back(self_message{id, std::vector<char>(h, h + header_size),
+                std::vector<char>(p, p + payload_size)});
+            return {};
+        }
+
+        auto const eager = (sizeof(packet) + header_size + payload_size <= m_eager_size);
+        auto const j = acquire_send_buffer();
+        auto const b = static_cast<char*>(m_send_buffers[j].get());
+        packet     pkt{id, m_comm->rank(), eager ? -1 : next_payload_tag(), 0u, header_size,
+            payload_size};
+        std::memcpy(b, &pkt, sizeof(packet));
+        if (header_size > 0u) std::memcpy(b + sizeof(packet), header, header_size);
+        auto size = sizeof(packet) + header_size;
+        if (eager && payload_size > 0u)
+        {
+            std::memcpy(b + size, payload_ptr, payload_size);
+            size += payload_size;
+        }
+        auto release_buffer = [this, j](rank_type, tag_type) { m_free_send_buffers.push_back(j); };
+        if (eager)
+            return m_comm->internal_send(m_send_buffers[j], size, dst, internal_tag::am_packet,
+                cb_type(std::move(release_buffer)), scheduled);
+
+        // the payload is sent from the user's buffer
+        m_comm->internal_send(m_send_buffers[j], size, dst, internal_tag::am_packet,
+            cb_type(std::move(release_buffer)), &m_scheduled);
+        return m_comm->internal_send(*payload, payload_size, dst, pkt.m_payload_tag,
+            cb_type([](rank_type, tag_type) {}), scheduled);
+    }
+
+    // deliver the messages to self
+    void progress()
+    {
+        if (m_self.empty() || !m_self_work.empty()) return;
+        m_self_work.swap(m_self);
+        while (!m_self_work.empty())
+        {
+            auto m = std::move(m_self_work.front());
+            m_self_work.pop_front();
+            invoke(am_message{m_comm->rank(), m.m_id, m.m_header.data(), m.m_header.size(),
+                m.m_payload.data(), m.m_payload.size()});
+        }
+    }
+
+    // cancel the posted receives, and wait for the internal operations which cannot be canceled
+    // (any more): messages which arrive now are dropped
+    void close()
+    {
+        if (m_closed) return;
+        m_closed = true;
+        for (auto& s : m_slots) s.m_req.cancel();
+        for (auto& r : m_payload_recvs) r.m_req.cancel();
+        while (m_scheduled > 0u) m_comm->progress();
+        for (auto& r : m_payload_recvs) r.m_ptr.release();
+        m_payload_recvs.clear();
+    }
+
+  private:
+    // the payload tags of the tag range, in turn
+    tag_type next_payload_tag()
+    {
+        auto const max_tag = m_comm->tag_range().max_tag();
+        auto const n = (std::uint64_t)(max_tag - internal_tag::am_payload) + 1u;
+        return internal_tag::am_payload + (tag_type)(m_comm->next_am_payload() % n);
+    }
+
+    pointer allocate(std::size_t size)
+    {
+        return m_comm->get_heap().allocate(size, hwmalloc::numa().local_node());
+    }
+
+    std::size_t acquire_send_buffer()
+    {
+        if (m_free_send_buffers.empty())
+        {
+            m_send_buffers.push_back(allocate(m_eager_size));
+            return m_send_buffers.size() - 1u;
+        }
+        auto const j = m_free_send_buffers.back();
+        m_free_send_buffers.pop_back();
+        return j;
+    }
+
+    void invoke(am_message const& m)
+    {
+        auto it = m_handlers.find(m.m_id);
+        if (it == m_handlers.end())
+            throw std::runtime_error("oomph: no handler registered for active message id");
+        it->second(m);
+    }
+
+    void post(std::size_t i)
+    {
+        m_slots[i].post(
+            [this, i](pointer& ptr)
+            {
+                return m_comm->internal_recv(ptr, m_eager_size, communicator::any_source,
+                    internal_tag::am_packet,
+                    cb_type([this, i](rank_type, tag_type) { on_packet(i); }), &m_scheduled);
+            });
+    }
+
+    void on_packet(std::size_t i)
+    {
+        if (m_closed) return;
+        auto const b = static_cast<char const*>(m_slots[i].m_buffer.get());
+        packet     pkt;
+        std::memcpy(&pkt, b, sizeof(packet));
+        auto const src = pkt.m_src;
+        auto const header = b + sizeof(packet);
+        if (pkt.m_payload_tag >= 0)
+        {
+            m_payload_recvs.push_back(payload_recv{src, pkt.m_id,
+                std::vector<char>(header, header + pkt.m_header_size), pkt.m_payload_size,
+                allocate(pkt.m_payload_size), recv_request()});
+            post(i);
+            post_payload(std::prev(m_payload_recvs.end()), pkt.m_payload_tag);
+        }
+        else
+        {
+            invoke(am_message{src, pkt.m_id, header, pkt.m_header_size,
+                header + pkt.m_header_size, pkt.m_payload_size});
+            if (!m_closed) post(i);
+        }
+    }
+
+    void post_payload(typename std::list<payload_recv>::iterator it, tag_type tag)
+    {
+        auto req = m_comm->internal_recv(it->m_ptr, it->m_payload_size, it->m_src, tag,
+            cb_type([this, it](rank_type, tag_type) { on_payload(it); }), &m_scheduled);
+        it->m_posting = false;
+        if (it->m_done) finish_payload(it);
+        else
+            it->m_req = std::move(req);
+    }
+
+    void on_payload(typename std::list<payload_recv>::iterator it)
+    {
+        if (m_closed) return;
+        invoke(am_message{it->m_src, it->m_id, it->m_header.data(), it->m_header.size(),
+            it->m_ptr.get(), it->m_payload_size});
+        // the receive completed before it could be stored: it is removed by post_payload
+        if (it->m_posting) it->m_done = true;
+        else
+            finish_payload(it);
+    }
+
+    void finish_payload(typename std::list<payload_recv>::iterator it)
+    {
+        it->m_ptr.release();
+        m_payload_recvs.erase(it);
+    }
+};
+
+} // namespace oomph
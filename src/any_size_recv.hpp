@@ -0,0 +1,214 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <hwmalloc/numa.hpp>
+#include <oomph/communicator.hpp>
+#include <oomph/request.hpp>
+
+namespace oomph
+{
+// Receives of messages whose size is not known in advance. A pending receive is matched by a
+// non-blocking probe of the backend, which removes the message from the matching queue and
+// reports its source, tag and size. A buffer of exactly that size is then allocated from the heap
+// of the context, the message is received into it with recv_probed, and the buffer is handed to
+// the callback together with the actual source and tag. Pending receives are probed when they are
+// posted and whenever the communicator progresses.
+//
+// The request returned to the user is a loopback request state (it is not tracked by the
+// transport): it is completed by this queue, and canceled through cancel. Messages to self are
+// taken from the loopback queue of the context, unless it is disabled, by receives from self and
+// from any source alike.
+//
+// Backends with has_probe provide
+//   struct probe_result { ...; rank_type m_src; tag_type m_tag; std::size_t m_size; };
+//   void check_probe(tag_type tag) const;   throws if probes with tag may leave the tag range
+//   bool probe(rank_type src, tag_type tag, probe_result& r);
+//   recv_request recv_probed(probe_result& r, pointer& ptr, cb_type&& cb, std::size_t* scheduled);
+template<typename Communicator>
+class any_size_queue
+{
+  public:
+    using heap_type = std::remove_reference_t<decltype(std::declval<Communicator&>().get_heap())>;
+    using pointer = typename heap_type::pointer;
+    using cb_type = util::unique_function<void(rank_type, tag_type)>;
+    using user_cb_type = util::unique_function<void(pointer, std::size_t, rank_type, tag_type)>;
+
+    // received message, handed to the user callback by the callback of the request state
+    struct message
+    {
+        user_cb_type m_cb;
+        pointer      m_ptr;
+        std::size_t  m_size = 0u;
+        bool         m_allocated = false;
+
+        message(user_cb_type&& cb)
+        : m_cb{std::move(cb)}
+        {
+        }
+
+        message(message const&) = delete;
+
+        // the buffer is only released here if it was never handed to the user
+        ~message()
+        {
+            if (m_allocated) m_ptr.release();
+        }
+
+        void deliver(rank_type src, tag_type tag)
+        {
+            m_allocated = false;
+            m_cb(m_ptr, m_size, src, tag);
+        }
+    };
+
+  private:
+    struct entry
+    {
+        rank_type              m_src;
+        tag_type               m_tag;
+        detail::request_state* m_state;
+        message*               m_msg;
+    };
+
+  private:
+    Communicator*      m_comm;
+    std::vector<entry> m_entries;
+    // receives of probed messages
+    std::size_t m_scheduled = 0u;
+    bool        m_in_progress = false;
+
+  public:
+    any_size_queue(Communicator* comm)
+    : m_comm{comm}
+    {
+    }
+
+    any_size_queue(any_size_queue const&) = delete;
+
+  public:
+    // drop the pending receives, and wait for the receives of messages which were probed already
+    void close()
+    {
+        for (auto& e : m_entries)
+            if (e.m_state) { auto ptr = e.m_state->release_self_ref(); }
+        m_entries.clear();
+        while (m_scheduled > 0u) m_comm->progress();
+    }
+
+    // s is a loopback request state whose callback invokes the user callback of m
+    void post(rank_type src, tag_type tag, detail::request_state* s, message* m)
+    {
+        entry e{src, tag, s, m};
+        // receives are matched in the order in which they were posted
+        if (!m_in_progress && m_entries.empty() && try_match(e)) return;
+        m_entries.push_back(e);
+    }
+
+    void progress()
+    {
+        if (m_in_progress || m_entries.empty()) return;
+        m_in_progress = true;
+        // callbacks may post new receives: these are appended and probed in the next round
+        auto const  n = m_entries.size();
+        std::size_t j = 0u;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (!m_entries[i].m_state || try_match(m_entries[i])) continue;
+            m_entries[j++] = m_entries[i];
+        }
+        m_entries.erase(m_entries.begin() + j, m_entries.begin() + n);
+        m_in_progress = false;
+    }
+
+    // cancel a pending receive: returns false if its message was probed already
+    bool cancel(detail::request_state* s)
+    {
+        auto it = std::find_if(m_entries.begin(), m_entries.end(),
+            [s](entry const& e) { return e.m_state == s; });
+        if (it == m_entries.end()) return false;
+        auto const e = *it;
+        // entries canceled by callbacks are removed by progress
+        if (m_in_progress) it->m_state = nullptr;
+        else
+            m_entries.erase(it);
+        auto ptr = e.m_state->release_self_ref();
+        e.m_state->set_canceled();
+        return true;
+    }
+
+  private:
+    pointer allocate(std::size_t size)
+    {
+        // zero-sized messages still get a buffer
+        return m_comm->get_heap().allocate(std::max<std::size_t>(size, 1u),
+            hwmalloc::numa().local_node());
+    }
+
+    bool try_match(entry e)
+    {
+        if (m_comm->is_loopback(e.m_src)) return take_loopback(e);
+        if (e.m_src == communicator::any_source && m_comm->is_loopback(m_comm->rank()) &&
+            take_loopback(e))
+            return true;
+
+        if constexpr (Communicator::has_probe)
+        {
+            typename Communicator::probe_result r;
+            if (!m_comm->probe(e.m_src, e.m_tag, r)) return false;
+            e.m_msg->m_ptr = allocate(r.m_size);
+            e.m_msg->m_size = r.m_size;
+            e.m_msg->m_allocated = true;
+            auto s = e.m_state;
+            s->m_rank = r.m_src;
+            s->m_tag = r.m_tag;
+            m_comm->recv_probed(r, e.m_msg->m_ptr,
+                cb_type(
+                    [s](rank_type, tag_type)
+                    {
+                        auto ptr = s->release_self_ref();
+                        s->invoke_cb();
+                    }),
+                &m_scheduled);
+            return true;
+        }
+        else
+            return false;
+    }
+
+    // messages to self are copied from the loopback queue, and delivered by its progress
+    bool take_loopback(entry e)
+    {
+        auto&       m = *e.m_msg;
+        std::size_t size;
+        tag_type    tag;
+        if (!m_comm->take_loopback(e.m_tag, size, tag,
+                [this, &m](std::size_t n)
+                {
+                    m.m_ptr = allocate(n);
+                    m.m_allocated = true;
+                    return m.m_ptr.get();
+                }))
+            return false;
+        m.m_size = size;
+        e.m_state->m_rank = m_comm->rank();
+        e.m_state->m_tag = tag;
+        m_comm->deliver_loopback(e.m_state);
+        return true;
+    }
+};
+
+} // namespace oomph
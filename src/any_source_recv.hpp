@@ -0,0 +1,165 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <oomph/request.hpp>
+#include <oomph/types.hpp>
+
+namespace oomph
+{
+// Receives from any source while the loopback queue is enabled: messages to self never reach the
+// transport, so such a receive is posted to the transport and kept in this queue as well. Whenever
+// a message to self with a matching tag is waiting in the loopback queue, the receive of the
+// transport is canceled and the message is taken from the loopback queue instead; if the cancel
+// fails, a message from the transport has arrived already and completes the receive. A message to
+// self may therefore be overtaken by a later message from another rank.
+//
+// The request of the user is a loopback request state (it is not tracked by the transport), which
+// is completed by the callback of the receive of the transport or by progress, and canceled
+// through cancel. The queue of the receives belongs to the communicator which posted them, the
+// queue of the shared receives to the context; the latter is progressed by all communicators.
+template<typename State, typename Request>
+class any_source_queue
+{
+  public:
+    // posts the receive of the transport, whose callback calls remove
+    using post_type = std::function<Request()>;
+
+  private:
+    using lock_type = std::unique_lock<std::mutex>;
+
+    struct entry
+    {
+        unsigned int m_range;
+        tag_type     m_tag;
+        void*        m_ptr;
+        std::size_t  m_size;
+        State*       m_state;
+        post_type    m_post;
+        Request      m_req = {};
+        bool         m_posted = false;
+    };
+
+  private:
+    bool const               m_thread_safe;
+    std::mutex               m_mutex;
+    std::vector<entry>       m_entries;
+    std::atomic<std::size_t> m_size{0u};
+
+  public:
+    any_source_queue(bool thread_safe)
+    : m_thread_safe{thread_safe}
+    {
+    }
+
+    any_source_queue(any_source_queue const&) = delete;
+
+  public:
+    bool empty() const noexcept { return m_size.load() == 0u; }
+
+    // s is a loopback request state for a receive of at most size bytes into ptr within the tag
+    // range
+    void post(unsigned int range, tag_type tag, void* ptr, std::size_t size, State* s,
+        post_type post)
+    {
+        {
+            auto lk = lock();
+            m_entries.push_back(entry{range, tag, ptr, size, s, post});
+            ++m_size;
+        }
+        // the receive may complete right away, and remove the entry
+        auto r = post();
+        auto lk = lock();
+        auto it = find(s);
+        if (it == m_entries.end()) return;
+        it->m_req = std::move(r);
+        it->m_posted = true;
+    }
+
+    // the receive of the transport has completed
+    void remove(State* s)
+    {
+        auto lk = lock();
+        auto it = find(s);
+        if (it != m_entries.end()) erase(it);
+    }
+
+    // cancel a pending receive: returns false if a message has arrived already
+    bool cancel(State* s)
+    {
+        Request r;
+        {
+            auto lk = lock();
+            auto it = find(s);
+            if (it == m_entries.end() || !it->m_posted) return false;
+            r = std::move(it->m_req);
+            erase(it);
+        }
+        if (!r.cancel()) return false;
+        auto ptr = s->release_self_ref();
+        s->set_canceled();
+        return true;
+    }
+
+    // available(range, tag) tells whether a message to self is waiting for a receive, and
+    // take(range, tag, ptr, size, s) copies it into ptr (of size bytes) and completes s: it returns
+    // false if the message was taken by another receive in the meantime, and the receive is posted
+    // again
+    template<typename Available, typename Take>
+    void progress(Available&& available, Take&& take)
+    {
+        if (empty()) return;
+        std::vector<entry> work;
+        {
+            auto lk = lock();
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+            {
+                if (!it->m_posted || !available(it->m_range, it->m_tag))
+                {
+                    ++it;
+                    continue;
+                }
+                work.push_back(std::move(*it));
+                it = erase(it);
+            }
+        }
+        for (auto& e : work)
+        {
+            // otherwise the receive completes through the transport
+            if (!e.m_req.cancel()) continue;
+            if (!take(e.m_range, e.m_tag, e.m_ptr, e.m_size, e.m_state))
+                post(e.m_range, e.m_tag, e.m_ptr, e.m_size, e.m_state, std::move(e.m_post));
+        }
+    }
+
+  private:
+    lock_type lock() { return m_thread_safe ? lock_type(m_mutex) : lock_type(); }
+
+    auto find(State* s)
+    {
+        return std::find_if(m_entries.begin(), m_entries.end(),
+            [s](entry const& e) { return e.m_state == s; });
+    }
+
+    auto erase(typename std::vector<entry>::iterator it)
+    {
+        --m_size;
+        return m_entries.erase(it);
+    }
+};
+
+} // namespace oomph
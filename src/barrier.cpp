@@ -14,69 +14,89 @@
 #if OOMPH_ENABLE_BARRIER
 // paths relative to backend
 #include <../communicator_set.hpp>
+#include <../hierarchical_barrier.hpp>
+#include <../message_buffer.hpp>
+#include <../util/heap_pimpl_src.hpp>
+
+OOMPH_INSTANTIATE_HEAP_PIMPL(oomph::hierarchical_barrier)
 
 namespace oomph
 {
 
 barrier::barrier(context const& c, size_t n_threads)
 : m_threads{n_threads}
-, b_count2{m_threads}
 , m_mpi_comm{c.mpi_comm()}
 , m_context{c.m.get()}
+, m_rank_barrier{m_mpi_comm}
 {
 }
 
+barrier::~barrier() = default;
+
 void
 barrier::operator()() const
 {
     if (in_node1()) rank_barrier();
-    else
-        while (b_count2 == m_threads) communicator_set::get().progress(m_context);
     in_node2();
 }
 
 void
 barrier::rank_barrier() const
 {
-    MPI_Request req = MPI_REQUEST_NULL;
-    int         flag;
-    MPI_Ibarrier(m_mpi_comm, &req);
-    while (true)
+    (*m_rank_barrier)([this]() { communicator_set::get().progress(m_context); });
+}
+
+barrier::token
+barrier::arrive() const
+{
+    // the thread completing the set of arrivals of an epoch drives the rank barrier
+    auto const n = m_arrived.m.fetch_add(1u, std::memory_order_acq_rel) + 1u;
+    token      t;
+    t.m_epoch = (n + m_threads - 1u) / m_threads;
+    t.m_owner = (n % m_threads) == 0u;
+    if (t.m_owner) m_rank_barrier->arrive();
+    return t;
+}
+
+bool
+barrier::test(token& t) const
+{
+    if (m_completed.m.load(std::memory_order_acquire) >= t.m_epoch) return true;
+    if (t.m_owner && m_rank_barrier->test())
     {
-        communicator_set::get().progress(m_context);
-        MPI_Test(&req, &flag, MPI_STATUS_IGNORE);
-        if (flag) break;
+        m_completed.m.store(t.m_epoch, std::memory_order_release);
+        return true;
     }
+    communicator_set::get().progress(m_context);
+    return false;
+}
+
+void
+barrier::wait(token& t) const
+{
+    while (!test(t)) {}
 }
 
 bool
 barrier::in_node1() const
 {
-    size_t expected = b_count;
-    while (!b_count.compare_exchange_weak(expected, expected + 1, std::memory_order_relaxed))
-        expected = b_count;
-    if (expected == m_threads - 1)
+    // the sense can only flip after this thread has arrived
+    auto const sense = m_sense.m.load(std::memory_order_acquire);
+    if (m_count.m.fetch_add(1u, std::memory_order_acq_rel) == m_threads - 1u)
     {
-        b_count.store(0);
+        m_count.m.store(0u, std::memory_order_relaxed);
+        m_sense.m.store(sense + 1u, std::memory_order_release);
         return true;
     }
-    else
-    {
-        while (b_count != 0) communicator_set::get().progress(m_context);
-        return false;
-    }
+    while (m_sense.m.load(std::memory_order_acquire) == sense)
+        communicator_set::get().progress(m_context);
+    return false;
 }
 
 void
 barrier::in_node2() const
 {
-    size_t ex = b_count2;
-    while (!b_count2.compare_exchange_weak(ex, ex - 1, std::memory_order_relaxed)) ex = b_count2;
-    if (ex == 1) { b_count2.store(m_threads); }
-    else
-    {
-        while (b_count2 != m_threads) communicator_set::get().progress(m_context);
-    }
+    in_node1();
 }
 } // namespace oomph
 
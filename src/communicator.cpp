@@ -39,6 +39,12 @@ communicator::is_local(rank_type rank) const noexcept
     return m_state->m_impl->is_local(rank);
 }
 
+tag_type
+communicator::max_tag() const noexcept
+{
+    return m_state->m_impl->tag_range().max_tag();
+}
+
 MPI_Comm
 communicator::mpi_comm() const noexcept
 {
@@ -77,28 +83,64 @@ communicator::end_group()
 
 send_request
 communicator::send(detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size,
-    rank_type dst, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream)
+    rank_type dst, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream,
+    priority p)
 {
-    return m_state->m_impl->send(m_ptr->m, size, dst, tag, std::move(cb),
-        &(m_state->scheduled_sends), stream);
+    return m_state->m_impl->user_send(m_ptr->m, size, dst, tag, std::move(cb),
+        &(m_state->scheduled_sends), stream, p);
 }
 
 recv_request
 communicator::recv(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size, rank_type src,
-    tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream)
+    tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream, priority p)
 {
-    return m_state->m_impl->recv(m_ptr->m, size, src, tag, std::move(cb),
-        &(m_state->scheduled_recvs), stream);
+    return m_state->m_impl->user_recv(m_ptr->m, size, src, tag, std::move(cb),
+        &(m_state->scheduled_recvs), stream, p);
+}
+
+void
+communicator::send_multi(detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size,
+    rank_type const* neighs, tag_type const* tags, tag_type tag,
+    util::unsafe_shared_ptr<detail::multi_request_state> const& mrs, void* stream)
+{
+    if (mrs->m_counter == 0ul) return;
+    mrs->m_self_ptr = mrs;
+    m_state->m_impl->send_multi(m_ptr->m, size, neighs, tags, tag, mrs.get(),
+        &(m_state->scheduled_sends), stream);
 }
 
 shared_recv_request
 communicator::shared_recv(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size,
     rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb, void* stream)
 {
-    return m_state->m_impl->shared_recv(m_ptr->m, size, src, tag, std::move(cb),
+    return m_state->m_impl->user_shared_recv(m_ptr->m, size, src, tag, std::move(cb),
         m_state->m_shared_scheduled_recvs, stream);
 }
 
+recv_request
+communicator::recv_any_size(rank_type src, tag_type tag,
+    util::unique_function<void(detail::message_buffer, std::size_t, rank_type, tag_type)>&& cb)
+{
+    return m_state->m_impl->recv_any_size(src, tag,
+        [cb = std::move(cb)](detail::heap_ptr ptr, std::size_t size, rank_type r,
+            tag_type t) mutable { cb(detail::message_buffer(std::move(ptr)), size, r, t); },
+        &(m_state->scheduled_recvs));
+}
+
+void
+communicator::register_am_handler(am_id id, am_handler&& handler)
+{
+    m_state->m_impl->register_am(id, std::move(handler));
+}
+
+send_request
+communicator::send_am(rank_type dst, am_id id, void const* header, std::size_t header_size,
+    detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size)
+{
+    return m_state->m_impl->send_am(dst, id, header, header_size, m_ptr ? &(m_ptr->m) : nullptr,
+        size, &(m_state->scheduled_sends));
+}
+
 detail::message_buffer
 communicator::make_buffer_core(std::size_t size)
 {
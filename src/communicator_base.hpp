@@ -9,11 +9,18 @@
  */
 #pragma once
 
+#include <memory>
+#include <stdexcept>
+
 #include <oomph/communicator.hpp>
+#include <oomph/util/tag_range.hpp>
 
 // paths relative to backend
 #include <../context_base.hpp>
 #include <../increment_guard.hpp>
+#include <../active_message.hpp>
+#include <../any_size_recv.hpp>
+#include <../flow_control.hpp>
 
 namespace oomph
 {
@@ -23,15 +30,46 @@ class communicator_base
   public:
     using pool_factory_type = util::pool_factory<detail::request_state>;
     using recursion_increment = increment_guard<std::size_t>;
+    using cb_type = util::unique_function<void(rank_type, tag_type)>;
+    using mailbox_type = context_base::loopback_type::mailbox;
+    using any_source_type = any_source_queue<detail::request_state, recv_request>;
+    // backends which cannot receive from any source override this
+    static constexpr bool has_flow_control = true;
+    // backends with a separate lane for priority::high override this and provide
+    // priority_lane_enabled, priority_send and priority_recv; otherwise (or if the lane is not
+    // enabled) all messages travel on the normal lane
+    static constexpr bool has_priority_lane = false;
+    // backends which can probe for messages override this and provide probe_result, probe and
+    // recv_probed (see any_size_queue); otherwise recv_any_size only matches messages to self
+    static constexpr bool has_probe = false;
 
   protected:
     context_base*     m_context;
     pool_factory_type m_req_state_factory;
     std::size_t       m_recursion_depth = 0u;
+    util::tag_range   m_tag_range;
+    mailbox_type      m_loopback_mailbox;
+    // receives from any source while the loopback queue is enabled
+    any_source_type m_any_source{false};
+    std::size_t     m_any_source_scheduled = 0u;
+    // created with the first active message operation
+    std::unique_ptr<am_engine<Communicator>> m_am;
+    // created with the first receive of unknown size
+    std::unique_ptr<any_size_queue<Communicator>> m_any_size;
+    // only created if enabled through the environment
+    std::unique_ptr<flow_control<Communicator>> m_flow;
 
     communicator_base(context_base* ctxt)
     : m_context(ctxt)
     {
+        if (Communicator::has_flow_control && m_context->credits().enabled())
+            m_flow = std::make_unique<flow_control<Communicator>>(static_cast<Communicator*>(this),
+                &m_context->credits());
+    }
+
+    ~communicator_base()
+    {
+        m_context->loopback().remove(m_loopback_mailbox);
     }
 
   public:
@@ -39,14 +77,388 @@ class communicator_base
     rank_type            size() const noexcept { return m_context->size(); }
     MPI_Comm             mpi_comm() const noexcept { return m_context->get_comm(); }
     rank_topology const& topology() const noexcept { return m_context->topology(); }
-    void release() { m_context->deregister_communicator(static_cast<Communicator*>(this)); }
+    void release()
+    {
+        if (m_am) m_am->close();
+        if (m_any_size) m_any_size->close();
+        if (m_flow) m_flow->close();
+        m_context->deregister_communicator(static_cast<Communicator*>(this));
+    }
     bool is_local(rank_type rank) const noexcept { return topology().is_local(rank); }
 
+    // numbers the payloads of active messages of the context (see am_engine)
+    std::uint64_t next_am_payload() noexcept { return m_context->next_am_payload(); }
+
+    util::tag_range const& tag_range() const noexcept { return m_tag_range; }
+    void                   set_tag_range(util::tag_range const& tr) noexcept { m_tag_range = tr; }
+
     bool has_reached_recursion_depth() const noexcept
     {
         return m_recursion_depth > OOMPH_RECURSION_DEPTH;
     }
 
     recursion_increment recursion() noexcept { return {m_recursion_depth}; }
+
+    // Messages to self are matched by the loopback queue of the context unless it is disabled.
+    // Device memory always goes through the transport. Backends create the request states of
+    // such operations through make_loopback_state and make_loopback_shared_state.
+    template<typename Pointer>
+    bool is_loopback(rank_type peer, [[maybe_unused]] Pointer const& ptr) const noexcept
+    {
+#if OOMPH_ENABLE_DEVICE
+        if (ptr.on_device()) return false;
+#endif
+        return is_loopback(peer);
+    }
+
+    bool is_loopback(rank_type peer) const noexcept
+    {
+        return (peer == rank()) && m_context->loopback().enabled();
+    }
+
+    // receives from any source which must take the messages to self from the loopback queue
+    template<typename Pointer>
+    bool is_any_source_loopback(rank_type src, Pointer const& ptr) const noexcept
+    {
+        return Communicator::has_flow_control && (src == communicator::any_source) &&
+               is_loopback(rank(), ptr);
+    }
+
+    // Sends and receives of the user: their tags must be in the tag range (see tag_range::check),
+    // and they are subject to the flow control if it is enabled, unless they go through the
+    // priority lane. Internal traffic uses the send and recv of the backend directly.
+    template<typename Pointer>
+    send_request user_send(Pointer const& ptr, std::size_t size, rank_type dst, tag_type tag,
+        cb_type&& cb, std::size_t* scheduled, void* stream, priority p = priority::normal)
+    {
+        m_tag_range.check(tag, false);
+        auto c = static_cast<Communicator*>(this);
+        if constexpr (Communicator::has_priority_lane)
+        {
+            if (p == priority::high && c->priority_lane_enabled())
+                return c->priority_send(ptr, size, dst, tag, std::move(cb), scheduled);
+        }
+        if (!m_flow || dst == rank() || m_flow->acquire(dst, tag))
+            return c->send(ptr, size, dst, tag, std::move(cb), scheduled, stream);
+        auto s = make_loopback_request(scheduled, dst, tag, std::move(cb));
+        m_flow->defer(ptr, size, dst, tag, s.get(), stream);
+        return {std::move(s)};
+    }
+
+    template<typename Pointer>
+    recv_request user_recv(Pointer& ptr, std::size_t size, rank_type src, tag_type tag,
+        cb_type&& cb, std::size_t* scheduled, void* stream, priority p = priority::normal)
+    {
+        m_tag_range.check(tag, true);
+        auto c = static_cast<Communicator*>(this);
+        if constexpr (Communicator::has_priority_lane)
+        {
+            if (p == priority::high && c->priority_lane_enabled())
+                return c->priority_recv(ptr, size, src, tag, std::move(cb), scheduled);
+        }
+        if (m_flow && src != rank() &&
+            (src == communicator::any_source || tag == communicator::any_tag))
+            throw std::runtime_error(
+                "oomph: recv from any_source or with any_tag returns no flow control credits");
+        if (is_any_source_loopback(src, ptr))
+            return any_source_recv(ptr, size, tag, std::move(cb), scheduled, stream);
+        if (!m_flow || src == rank())
+            return c->recv(ptr, size, src, tag, std::move(cb), scheduled, stream);
+        return c->recv(ptr, size, src, tag,
+            cb_type(
+                [f = m_flow.get(), cb = std::move(cb)](rank_type r, tag_type t) mutable
+                {
+                    cb(r, t);
+                    f->consumed(r, t);
+                }),
+            scheduled, stream);
+    }
+
+    template<typename Pointer>
+    send_request send_loopback(Pointer const& ptr, std::size_t size, rank_type dst, tag_type tag,
+        cb_type&& cb, std::size_t* scheduled)
+    {
+        util::unsafe_shared_ptr<detail::request_state> s;
+        auto const completed = m_context->loopback().send(m_tag_range.index(), tag, ptr.get(),
+            size, m_loopback_mailbox,
+            [&]()
+            {
+                s = make_loopback_request(scheduled, dst, tag, std::move(cb));
+                return s.get();
+            });
+        if (!completed) return {std::move(s)};
+        if (!has_reached_recursion_depth())
+        {
+            auto inc = recursion();
+            cb(dst, tag);
+            return {};
+        }
+        s = make_loopback_request(scheduled, dst, tag, std::move(cb));
+        m_context->loopback().deliver(m_loopback_mailbox, s.get());
+        return {std::move(s)};
+    }
+
+    template<typename Pointer>
+    recv_request recv_loopback(Pointer& ptr, std::size_t size, rank_type src, tag_type tag,
+        cb_type&& cb, std::size_t* scheduled)
+    {
+        util::unsafe_shared_ptr<detail::request_state> s;
+        auto const matched = m_context->loopback().recv(m_tag_range.index(), tag, ptr.get(), size,
+            m_loopback_mailbox,
+            [&]()
+            {
+                s = make_loopback_request(scheduled, src, tag, std::move(cb));
+                return s.get();
+            });
+        if (!matched) return {std::move(s)};
+        if (!has_reached_recursion_depth())
+        {
+            auto inc = recursion();
+            cb(src, tag);
+            return {};
+        }
+        s = make_loopback_request(scheduled, src, tag, std::move(cb));
+        m_context->loopback().deliver(m_loopback_mailbox, s.get());
+        return {std::move(s)};
+    }
+
+    template<typename Pointer>
+    shared_recv_request shared_recv_loopback(Pointer& ptr, std::size_t size, rank_type src,
+        tag_type tag, cb_type&& cb, std::atomic<std::size_t>* scheduled)
+    {
+        std::shared_ptr<detail::shared_request_state> s;
+        auto const matched = m_context->loopback().shared_recv(m_tag_range.index(), tag,
+            ptr.get(), size,
+            [&]()
+            {
+                s = make_loopback_shared_request(scheduled, src, tag, std::move(cb));
+                return s.get();
+            });
+        if (!matched) return {std::move(s)};
+        if (!m_context->has_reached_recursion_depth())
+        {
+            auto inc = m_context->recursion();
+            cb(src, tag);
+            return {};
+        }
+        s = make_loopback_shared_request(scheduled, src, tag, std::move(cb));
+        m_context->loopback().deliver_shared(s.get());
+        return {std::move(s)};
+    }
+
+    // shared receives of the user: those from any source also take the messages to self, see
+    // any_source_queue
+    template<typename Pointer>
+    shared_recv_request user_shared_recv(Pointer& ptr, std::size_t size, rank_type src,
+        tag_type tag, cb_type&& cb, std::atomic<std::size_t>* scheduled, void* stream)
+    {
+        m_tag_range.check(tag, true);
+        if (m_flow && src != rank())
+            throw std::runtime_error("oomph: shared_recv returns no flow control credits");
+        auto c = static_cast<Communicator*>(this);
+        if (!is_any_source_loopback(src, ptr))
+            return c->shared_recv(ptr, size, src, tag, std::move(cb), scheduled, stream);
+        std::size_t n;
+        tag_type    t;
+        if (take_loopback(tag, ptr.get(), size, n, t))
+        {
+            if (!m_context->has_reached_recursion_depth())
+            {
+                auto inc = m_context->recursion();
+                cb(rank(), t);
+                return {};
+            }
+            auto s = make_loopback_shared_request(scheduled, rank(), t, std::move(cb));
+            m_context->loopback().deliver_shared(s.get());
+            return {std::move(s)};
+        }
+        auto  s = make_loopback_shared_request(scheduled, src, tag, std::move(cb));
+        auto& q = m_context->any_source();
+        q.post(m_tag_range.index(), tag, ptr.get(), size, s.get(),
+            [c, &q, ptr, size, tag, s = s.get(), sch = m_context->any_source_scheduled(),
+                stream]() mutable
+            {
+                return c->shared_recv(ptr, size, communicator::any_source, tag,
+                    cb_type([&q, s](rank_type r, tag_type t) { on_any_source(q, s, r, t); }),
+                    sch, stream);
+            });
+        return {std::move(s)};
+    }
+
+    // match a receive of unknown size against the messages to self, see loopback_queue::take
+    template<typename Allocate>
+    bool take_loopback(tag_type tag, std::size_t& size, tag_type& msg_tag, Allocate&& allocate)
+    {
+        return m_context->loopback().take(m_tag_range.index(), tag, size, msg_tag,
+            std::forward<Allocate>(allocate));
+    }
+
+    // match a receive into ptr with capacity bytes against the messages to self
+    bool take_loopback(tag_type tag, void* ptr, std::size_t capacity, std::size_t& size,
+        tag_type& msg_tag)
+    {
+        return m_context->loopback().take(m_tag_range.index(), tag, ptr, capacity, size, msg_tag);
+    }
+
+    // complete a loopback request with the next progress
+    void deliver_loopback(detail::request_state* s)
+    {
+        m_context->loopback().deliver(m_loopback_mailbox, s);
+    }
+
+    // cancel a receive which is not tracked by the transport
+    bool cancel_loopback(detail::request_state* s)
+    {
+        if (m_context->loopback().cancel(s)) return true;
+        if (m_any_source.cancel(s)) return true;
+        return m_any_size && m_any_size->cancel(s);
+    }
+
+    // hand the messages to self to the receives from any source, invoke the callbacks of the
+    // operations completed by the loopback queue, deliver the active messages to self and probe for
+    // the pending receives of unknown size
+    void progress_loopback()
+    {
+        m_context->loopback().progress_any_source(m_any_source, rank(), &m_loopback_mailbox);
+        m_context->loopback().progress(m_loopback_mailbox);
+        m_context->loopback().progress_shared();
+        if (m_am) m_am->progress();
+        if (m_any_size) m_any_size->progress();
+        if (m_flow) m_flow->progress();
+    }
+
+    // receive a message of unknown size into a buffer of the heap: cb is invoked with the buffer
+    // (which is owned by the callee), the size of the message and its source and tag
+    template<typename CallBack>
+    recv_request recv_any_size(rank_type src, tag_type tag, CallBack&& cb, std::size_t* scheduled)
+    {
+        m_tag_range.check(tag, true);
+        if constexpr (Communicator::has_probe) static_cast<Communicator*>(this)->check_probe(tag);
+        using queue_type = any_size_queue<Communicator>;
+        using message = typename queue_type::message;
+        using user_cb_type = typename queue_type::user_cb_type;
+        auto m = std::make_unique<message>(user_cb_type(std::forward<CallBack>(cb)));
+        if (m_flow)
+            m->m_cb = user_cb_type(
+                [f = m_flow.get(), me = rank(), cb = std::move(m->m_cb)](
+                    typename queue_type::pointer ptr, std::size_t size, rank_type r,
+                    tag_type t) mutable
+                {
+                    cb(std::move(ptr), size, r, t);
+                    if (r != me) f->consumed(r, t);
+                });
+        auto const mp = m.get();
+        auto       s = make_loopback_request(scheduled, src, tag,
+                  cb_type([m = std::move(m)](rank_type r, tag_type t) { m->deliver(r, t); }));
+        any_size().post(src, tag, s.get(), mp);
+        return {std::move(s)};
+    }
+
+    void register_am(am_id id, am_handler&& h) { am().register_handler(id, std::move(h)); }
+
+    template<typename Pointer>
+    send_request send_am(rank_type dst, am_id id, void const* header, std::size_t header_size,
+        Pointer const* payload, std::size_t payload_size, std::size_t* scheduled)
+    {
+        return am().send(dst, id, header, header_size, payload, payload_size, scheduled);
+    }
+
+    // Post the same message to all neighbors in one pass. The sends share the multi request
+    // state: their callbacks only hold a raw pointer to it, and it is completed (and its callback
+    // invoked) once, when the counter drops to zero. Backends may override this to batch the
+    // sends.
+    template<typename Pointer>
+    void send_multi(Pointer const& ptr, std::size_t size, rank_type const* neighs,
+        tag_type const* tags, tag_type tag, detail::multi_request_state* mrs,
+        std::size_t* scheduled, void* stream)
+    {
+        // the counter may drop while we are posting
+        auto const n = mrs->m_counter;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            user_send(ptr, size, neighs[i], tags ? tags[i] : tag,
+                util::unique_function<void(rank_type, tag_type)>(
+                    detail::multi_request_callback{mrs}),
+                scheduled, stream);
+        }
+    }
+
+  private:
+    // see any_source_queue: the receive is completed right away if a message to self is waiting
+    template<typename Pointer>
+    recv_request any_source_recv(Pointer& ptr, std::size_t size, tag_type tag, cb_type&& cb,
+        std::size_t* scheduled, void* stream)
+    {
+        std::size_t n;
+        tag_type    t;
+        if (take_loopback(tag, ptr.get(), size, n, t))
+        {
+            if (!has_reached_recursion_depth())
+            {
+                auto inc = recursion();
+                cb(rank(), t);
+                return {};
+            }
+            auto s = make_loopback_request(scheduled, rank(), t, std::move(cb));
+            deliver_loopback(s.get());
+            return {std::move(s)};
+        }
+        auto s = make_loopback_request(scheduled, communicator::any_source, tag, std::move(cb));
+        m_any_source.post(m_tag_range.index(), tag, ptr.get(), size, s.get(),
+            [this, ptr, size, tag, s = s.get(), stream]() mutable
+            {
+                return static_cast<Communicator*>(this)->recv(ptr, size, communicator::any_source,
+                    tag,
+                    cb_type([this, s](rank_type r, tag_type t)
+                        { on_any_source(m_any_source, s, r, t); }),
+                    &m_any_source_scheduled, stream);
+            });
+        return {std::move(s)};
+    }
+
+    // the receive of the transport of a receive from any source has completed
+    template<typename Queue, typename RequestState>
+    static void on_any_source(Queue& q, RequestState* s, rank_type r, tag_type t)
+    {
+        q.remove(s);
+        s->m_rank = r;
+        s->m_tag = t;
+        auto ptr = s->release_self_ref();
+        s->invoke_cb();
+    }
+
+    am_engine<Communicator>& am()
+    {
+        if (!m_am)
+            m_am = std::make_unique<am_engine<Communicator>>(static_cast<Communicator*>(this));
+        return *m_am;
+    }
+
+    any_size_queue<Communicator>& any_size()
+    {
+        if (!m_any_size)
+            m_any_size =
+                std::make_unique<any_size_queue<Communicator>>(static_cast<Communicator*>(this));
+        return *m_any_size;
+    }
+
+    auto make_loopback_request(std::size_t* scheduled, rank_type rank, tag_type tag, cb_type&& cb)
+    {
+        auto s = static_cast<Communicator*>(this)->make_loopback_state(scheduled, rank, tag,
+            std::move(cb));
+        s->m_loopback = true;
+        s->create_self_ref();
+        return s;
+    }
+
+    auto make_loopback_shared_request(std::atomic<std::size_t>* scheduled, rank_type rank,
+        tag_type tag, cb_type&& cb)
+    {
+        auto s = static_cast<Communicator*>(this)->make_loopback_shared_state(scheduled, rank, tag,
+            std::move(cb));
+        s->m_loopback = true;
+        s->create_self_ref();
+        return s;
+    }
 };
 } // namespace oomph
@@ -24,23 +24,29 @@ OOMPH_INSTANTIATE_HEAP_PIMPL(oomph::detail::message_buffer::heap_ptr_impl)
 namespace oomph
 {
 
-context::context(MPI_Comm comm, bool thread_safe, //unsigned int num_tag_ranges,
+context::context(MPI_Comm comm, bool thread_safe, hwmalloc::heap_config const& heap_config)
+: context(comm, thread_safe, 0u, heap_config)
+{
+}
+
+context::context(MPI_Comm comm, bool thread_safe, unsigned int num_tag_ranges,
     hwmalloc::heap_config const& heap_config)
 : m_mpi_comm{comm}
 , m(m_mpi_comm.get(), thread_safe, heap_config)
 , m_schedule{std::make_unique<schedule>()}
-//, m_tag_range_factory(num_tag_ranges, m->num_tag_bits())
+, m_tag_range_factory(num_tag_ranges, m->num_tag_bits())
 {
 }
 
 context::~context() { communicator_set::get().erase(m.get()); }
 
 communicator
-context::get_communicator()//unsigned int tr)
+context::get_communicator(unsigned int tr)
 {
-    return {m->get_communicator(), &(m_schedule->scheduled_recvs)};
-    //, m_tag_range_factory.create(tr),
-    //    m_tag_range_factory.create(tr, true)};
+    auto tag_range = m_tag_range_factory.create(tr);
+    auto impl = m->get_communicator();
+    impl->set_tag_range(tag_range);
+    return {impl, &(m_schedule->scheduled_recvs)};
 }
 
 rank_type
@@ -11,6 +11,7 @@
 
 #include <iostream>
 #include <atomic>
+#include <cstdint>
 #include <oomph/context.hpp>
 
 // paths relative to backend
@@ -18,6 +19,10 @@
 #include <../unique_ptr_set.hpp>
 #include <../rank_topology.hpp>
 #include <../increment_guard.hpp>
+#include <../loopback.hpp>
+#include <../any_source_recv.hpp>
+#include <../credit_pool.hpp>
+#include <../thresholds.hpp>
 
 namespace oomph
 {
@@ -25,19 +30,30 @@ class context_base
 {
   public:
     using recursion_increment = increment_guard<std::atomic<std::size_t>>;
+    using loopback_type = loopback_queue<detail::request_state, detail::shared_request_state>;
+    using any_source_type = any_source_queue<detail::shared_request_state, shared_recv_request>;
 
   protected:
     mpi_comm                          m_mpi_comm;
     bool const                        m_thread_safe;
     rank_topology const               m_rank_topology;
+    loopback_type                     m_loopback; // outlives the communicators
+    any_source_type                   m_any_source; // shared receives from any source
+    std::atomic<std::size_t>          m_any_source_scheduled = 0u;
+    credit_pool                       m_credits;
+    thresholds const                  m_thresholds;
     unique_ptr_set<communicator_impl> m_comms_set;
     std::atomic<std::size_t>          m_recursion_depth = 0u;
+    std::atomic<std::uint64_t>        m_am_payload_seq = 0u; // numbers active message payloads
 
   public:
     context_base(MPI_Comm comm, bool thread_safe)
     : m_mpi_comm{comm}
     , m_thread_safe{thread_safe}
     , m_rank_topology(comm)
+    , m_loopback(thread_safe)
+    , m_any_source(thread_safe)
+    , m_credits(thread_safe)
     {
         int mpi_thread_safety;
         OOMPH_CHECK_MPI_RESULT(MPI_Query_thread(&mpi_thread_safety));
@@ -53,9 +69,19 @@ class context_base
     rank_topology const& topology() const noexcept { return m_rank_topology; }
     MPI_Comm             get_comm() const noexcept { return m_mpi_comm; }
     bool                 thread_safe() const noexcept { return m_thread_safe; }
+    loopback_type&       loopback() noexcept { return m_loopback; }
+    any_source_type&     any_source() noexcept { return m_any_source; }
+    credit_pool&         credits() noexcept { return m_credits; }
+    thresholds const&    protocol_thresholds() const noexcept { return m_thresholds; }
+
+    // receives of the transport of the shared receives from any source
+    std::atomic<std::size_t>* any_source_scheduled() noexcept { return &m_any_source_scheduled; }
 
     void deregister_communicator(communicator_impl* c) { m_comms_set.remove(c); }
 
+    // payloads of active messages are sent with the payload tags in turn (see am_engine)
+    std::uint64_t next_am_payload() noexcept { return m_am_payload_seq++; }
+
     bool has_reached_recursion_depth() const noexcept
     {
         return m_recursion_depth > OOMPH_RECURSION_DEPTH;
@@ -0,0 +1,135 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include <oomph/types.hpp>
+
+namespace oomph
+{
+// ----------------------------------------
+// messages in flight per destination
+// ----------------------------------------
+static std::size_t
+flow_credits()
+{
+    auto env_str = std::getenv("OOMPH_FLOW_CREDITS");
+    if (env_str != nullptr)
+    {
+        char* end;
+        return std::strtoull(env_str, &end, 0);
+    }
+    return 0u;
+}
+
+// Credits of the flow control (see flow_control), per tag range, peer and tag. There is one pool
+// per context: a receiver cannot tell which communicator of the sender a message came from, so all
+// communicators of a tag range spend and return the same credits.
+class credit_pool
+{
+  private:
+    using lock_type = std::unique_lock<std::mutex>;
+
+    // messages with the same source and tag are matched in order: a window per stream cannot be
+    // blocked by messages which the receiver consumes later
+    struct stream
+    {
+        unsigned int m_range;
+        rank_type    m_rank;
+        tag_type     m_tag;
+
+        bool operator==(stream const& other) const noexcept
+        {
+            return m_range == other.m_range && m_rank == other.m_rank && m_tag == other.m_tag;
+        }
+    };
+
+    struct stream_hash
+    {
+        std::size_t operator()(stream const& s) const noexcept
+        {
+            auto const a = ((std::uint64_t)s.m_range << 32) | (std::uint32_t)s.m_rank;
+            return std::hash<std::uint64_t>{}(a * 0x9e3779b97f4a7c15ull ^ (std::uint32_t)s.m_tag);
+        }
+    };
+
+    struct state
+    {
+        // credits left for sending to the peer
+        std::size_t m_credits;
+        // messages received from the peer whose credits have not been returned yet
+        std::size_t m_consumed = 0u;
+    };
+
+  private:
+    std::size_t const                              m_credits;
+    std::size_t const                              m_batch;
+    bool const                                     m_thread_safe;
+    std::mutex                                     m_mutex;
+    std::unordered_map<stream, state, stream_hash> m_streams;
+
+  public:
+    credit_pool(bool thread_safe)
+    : m_credits{flow_credits()}
+    , m_batch{std::max<std::size_t>(m_credits / 2u, 1u)}
+    , m_thread_safe{thread_safe}
+    {
+    }
+
+    credit_pool(credit_pool const&) = delete;
+
+  public:
+    bool enabled() const noexcept { return m_credits > 0u; }
+
+    // spend a credit for a message to dst: returns false if there is none
+    bool acquire(unsigned int range, rank_type dst, tag_type tag)
+    {
+        auto  lk = lock();
+        auto& p = get(range, dst, tag);
+        if (p.m_credits == 0u) return false;
+        --p.m_credits;
+        return true;
+    }
+
+    // credits returned by src
+    void add(unsigned int range, rank_type src, tag_type tag, std::size_t credits)
+    {
+        auto lk = lock();
+        get(range, src, tag).m_credits += credits;
+    }
+
+    // a message from src has been received: returns the number of credits to be returned to src
+    // now, which is non-zero once per batch
+    std::size_t consume(unsigned int range, rank_type src, tag_type tag)
+    {
+        auto  lk = lock();
+        auto& p = get(range, src, tag);
+        if (++p.m_consumed < m_batch) return 0u;
+        auto const credits = p.m_consumed;
+        p.m_consumed = 0u;
+        return credits;
+    }
+
+  private:
+    lock_type lock() { return m_thread_safe ? lock_type(m_mutex) : lock_type(); }
+
+    state& get(unsigned int range, rank_type r, tag_type tag)
+    {
+        return m_streams.try_emplace(stream{range, r, tag}, state{m_credits}).first->second;
+    }
+};
+
+} // namespace oomph
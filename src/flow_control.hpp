@@ -0,0 +1,258 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <hwmalloc/numa.hpp>
+#include <oomph/communicator.hpp>
+#include <oomph/detail/recv_slot.hpp>
+#include <oomph/request.hpp>
+#include <../credit_pool.hpp>
+#include <../internal_tags.hpp>
+
+namespace oomph
+{
+// Credit-based flow control of the messages sent by the user. A sender starts with credits
+// credits per destination and tag and spends one per message; sends without credits are queued
+// (in order) and their requests complete only after they have been handed to the transport. The
+// receiver counts the completed receives per source and tag and returns the credits in batches of
+// half the window, with a small control message on the internal lane (see internal_tag). Thus no
+// more than credits messages of a sender and tag can be waiting in the unexpected queue of a
+// receiver. Since messages with the same source and tag are matched in order, a send without
+// credits only waits for receives which the receiver has to post before the matching one anyway.
+// The credits are kept per tag range in the credit_pool of the context, and the communicators of a
+// range share them: control messages may be received by any of them.
+//
+// Receives from any_source or with any_tag do not know the sender and tag of their message, and
+// shared receives complete on other communicators: none of them could return credits, and the
+// sender would wait forever, so they throw while the flow control is enabled. Messages from a peer
+// must be received with recv naming the source and tag, or with recv_any_size (which reports
+// them). Messages to self are not counted.
+//
+// Configured through the environment (identically on all ranks):
+//   OOMPH_FLOW_CREDITS=<n>     messages in flight per destination and tag (default: 0, disabled)
+template<typename Communicator>
+class flow_control
+{
+  public:
+    using heap_type = std::remove_reference_t<decltype(std::declval<Communicator&>().get_heap())>;
+    using pointer = typename heap_type::pointer;
+    using cb_type = util::unique_function<void(rank_type, tag_type)>;
+
+  private:
+    // control message returning credits: receives from any source do not report the source
+    struct credit_message
+    {
+        std::int32_t  m_src;
+        std::int32_t  m_tag;
+        std::uint32_t m_credits;
+    };
+
+    struct deferred_send
+    {
+        pointer                m_ptr;
+        std::size_t            m_size;
+        detail::request_state* m_state;
+        void*                  m_stream;
+    };
+
+    // destination and tag
+    using stream_id = std::pair<rank_type, tag_type>;
+
+    struct stream_hash
+    {
+        std::size_t operator()(stream_id const& s) const noexcept
+        {
+            return std::hash<std::uint64_t>{}(
+                ((std::uint64_t)(std::uint32_t)s.first << 32) | (std::uint32_t)s.second);
+        }
+    };
+
+    using deferred_map = std::unordered_map<stream_id, std::deque<deferred_send>, stream_hash>;
+
+    using slot = detail::recv_slot<pointer>;
+
+    static constexpr std::size_t num_slots = 4u;
+
+  private:
+    Communicator*            m_comm;
+    credit_pool*             m_pool;
+    deferred_map             m_deferred;
+    std::size_t              m_num_deferred = 0u;
+    std::vector<stream_id>   m_flush_streams;
+    std::vector<slot>        m_slots;
+    std::vector<pointer>     m_send_buffers;
+    std::vector<std::size_t> m_free_send_buffers;
+    // control messages and deferred sends handed to the transport
+    std::size_t m_scheduled = 0u;
+    bool        m_closed = false;
+
+  public:
+    flow_control(Communicator* comm, credit_pool* pool)
+    : m_comm{comm}
+    , m_pool{pool}
+    {
+    }
+
+    flow_control(flow_control const&) = delete;
+
+    ~flow_control()
+    {
+        for (auto& s : m_slots) s.m_buffer.release();
+        for (auto& p : m_send_buffers) p.release();
+    }
+
+  public:
+    // spend a credit for a message to dst: returns false if the message must be deferred
+    bool acquire(rank_type dst, tag_type tag)
+    {
+        if (m_slots.empty()) start();
+        // keep the order of the messages
+        if (m_num_deferred > 0u)
+        {
+            auto it = m_deferred.find({dst, tag});
+            if (it != m_deferred.end() && !it->second.empty()) return false;
+        }
+        return m_pool->acquire(range(), dst, tag);
+    }
+
+    // s is a loopback request state which is completed once the send has completed
+    void defer(pointer const& ptr, std::size_t size, rank_type dst, tag_type tag,
+        detail::request_state* s, void* stream)
+    {
+        m_deferred[{dst, tag}].push_back(deferred_send{ptr, size, s, stream});
+        ++m_num_deferred;
+    }
+
+    // a receive of a message from src with tag has completed
+    void consumed(rank_type src, tag_type tag)
+    {
+        if (m_closed) return;
+        if (auto const credits = m_pool->consume(range(), src, tag))
+            send_credits(src, tag, credits);
+    }
+
+    // hand the deferred sends to the transport for which credits have arrived (possibly through
+    // another communicator)
+    void progress()
+    {
+        if (m_num_deferred == 0u) return;
+        // callbacks of sends may defer messages to new destinations
+        m_flush_streams.clear();
+        for (auto const& kv : m_deferred) m_flush_streams.push_back(kv.first);
+        for (auto const& id : m_flush_streams) flush(id, m_deferred[id]);
+    }
+
+    // drop the deferred sends, cancel the posted receives and wait for the messages which were
+    // handed to the transport
+    void close()
+    {
+        if (m_closed) return;
+        m_closed = true;
+        for (auto& kv : m_deferred)
+            for (auto& d : kv.second) { auto ptr = d.m_state->release_self_ref(); }
+        m_deferred.clear();
+        m_num_deferred = 0u;
+        for (auto& s : m_slots) s.m_req.cancel();
+        while (m_scheduled > 0u) m_comm->progress();
+    }
+
+  private:
+    // the tag range is assigned after construction
+    unsigned int range() const noexcept { return m_comm->tag_range().index(); }
+
+    pointer allocate(std::size_t size)
+    {
+        return m_comm->get_heap().allocate(size, hwmalloc::numa().local_node());
+    }
+
+    // post the receives of the control messages
+    void start()
+    {
+        m_slots.resize(num_slots);
+        for (auto& s : m_slots) s.m_buffer = allocate(sizeof(credit_message));
+        for (std::size_t i = 0; i < num_slots; ++i) post(i);
+    }
+
+    void post(std::size_t i)
+    {
+        m_slots[i].post(
+            [this, i](pointer& ptr)
+            {
+                return m_comm->internal_recv(ptr, sizeof(credit_message),
+                    communicator::any_source, internal_tag::credits,
+                    cb_type([this, i](rank_type, tag_type) { on_credits(i); }), &m_scheduled);
+            });
+    }
+
+    void on_credits(std::size_t i)
+    {
+        credit_message m;
+        std::memcpy(&m, m_slots[i].m_buffer.get(), sizeof(credit_message));
+        // the credits belong to the pool even if this communicator is closing
+        m_pool->add(range(), m.m_src, m.m_tag, m.m_credits);
+        if (m_closed) return;
+        post(i);
+        auto it = m_deferred.find({m.m_src, m.m_tag});
+        if (it != m_deferred.end()) flush(it->first, it->second);
+    }
+
+    // hand the deferred sends to the transport while there are credits
+    void flush(stream_id const& id, std::deque<deferred_send>& deferred)
+    {
+        while (!deferred.empty() && m_pool->acquire(range(), id.first, id.second))
+        {
+            auto d = std::move(deferred.front());
+            deferred.pop_front();
+            --m_num_deferred;
+            auto s = d.m_state;
+            // the callback may run right away and send to dst again: such sends are appended
+            m_comm->send(d.m_ptr, d.m_size, id.first, id.second,
+                cb_type(
+                    [s](rank_type, tag_type)
+                    {
+                        auto ptr = s->release_self_ref();
+                        s->invoke_cb();
+                    }),
+                &m_scheduled, d.m_stream);
+        }
+    }
+
+    void send_credits(rank_type dst, tag_type tag, std::size_t credits)
+    {
+        std::size_t j;
+        if (m_free_send_buffers.empty())
+        {
+            m_send_buffers.push_back(allocate(sizeof(credit_message)));
+            j = m_send_buffers.size() - 1u;
+        }
+        else
+        {
+            j = m_free_send_buffers.back();
+            m_free_send_buffers.pop_back();
+        }
+        credit_message const m{m_comm->rank(), tag, (std::uint32_t)credits};
+        std::memcpy(m_send_buffers[j].get(), &m, sizeof(credit_message));
+        m_comm->internal_send(m_send_buffers[j], sizeof(credit_message), dst,
+            internal_tag::credits,
+            cb_type([this, j](rank_type, tag_type) { m_free_send_buffers.push_back(j); }),
+            &m_scheduled);
+    }
+};
+
+} // namespace oomph
@@ -0,0 +1,172 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <oomph/util/mpi_error.hpp>
+
+namespace oomph
+{
+/**
+ * Topology aware rank barrier. It proceeds in three steps:
+ * 1. the ranks on a node announce their arrival by incrementing a counter in shared memory,
+ * 2. the node leaders (local rank 0) run a dissemination barrier among each other using
+ *    zero-byte point-to-point messages on a communicator of their own,
+ * 3. the leaders release the ranks of their node through a second shared-memory counter.
+ *
+ * Both counters are monotonic: in epoch e, the node is complete once e * node_size arrivals
+ * have been counted, and the ranks are released once the release counter reaches e. An epoch is
+ * started with arrive() and completed by polling test(), which never blocks. Construction and
+ * destruction are collective over the communicator passed to the constructor.
+ */
+class hierarchical_barrier
+{
+  private:
+    using counter_type = std::atomic<std::uint64_t>;
+    static_assert(counter_type::is_always_lock_free, "shared memory counters must be lock free");
+
+    enum class phase
+    {
+        gather,
+        exchange,
+        done
+    };
+
+    struct node_state
+    {
+        alignas(64) counter_type m_arrived;
+        alignas(64) counter_type m_released;
+    };
+
+  private:
+    MPI_Comm      m_node_comm = MPI_COMM_NULL;
+    MPI_Comm      m_leader_comm = MPI_COMM_NULL;
+    MPI_Win       m_win = MPI_WIN_NULL;
+    node_state*   m_state = nullptr;
+    std::uint64_t m_node_size = 1;
+    int           m_leader_rank = 0;
+    int           m_num_leaders = 1;
+    std::uint64_t m_epoch = 0;
+    phase         m_phase = phase::done;
+    int           m_round = 0;
+    MPI_Request   m_reqs[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+
+  public:
+    hierarchical_barrier(MPI_Comm comm)
+    {
+        int rank, node_rank, node_size;
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_rank(comm, &rank));
+        OOMPH_CHECK_MPI_RESULT(
+            MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &m_node_comm));
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_rank(m_node_comm, &node_rank));
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_size(m_node_comm, &node_size));
+        m_node_size = node_size;
+
+        // node state lives in the segment of the leader
+        void* base;
+        OOMPH_CHECK_MPI_RESULT(
+            MPI_Win_allocate_shared(is_leader(node_rank) ? sizeof(node_state) : 0, 1,
+                MPI_INFO_NULL, m_node_comm, &base, &m_win));
+        MPI_Aint size;
+        int      disp;
+        OOMPH_CHECK_MPI_RESULT(MPI_Win_shared_query(m_win, 0, &size, &disp, &base));
+        if (is_leader(node_rank)) m_state = new (base) node_state{{0u}, {0u}};
+        else
+            m_state = static_cast<node_state*>(base);
+        OOMPH_CHECK_MPI_RESULT(MPI_Win_lock_all(MPI_MODE_NOCHECK, m_win));
+        OOMPH_CHECK_MPI_RESULT(MPI_Barrier(m_node_comm));
+
+        // communicator among node leaders
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_split(comm, is_leader(node_rank) ? 0 : MPI_UNDEFINED,
+            rank, &m_leader_comm));
+        if (m_leader_comm != MPI_COMM_NULL)
+        {
+            OOMPH_CHECK_MPI_RESULT(MPI_Comm_rank(m_leader_comm, &m_leader_rank));
+            OOMPH_CHECK_MPI_RESULT(MPI_Comm_size(m_leader_comm, &m_num_leaders));
+        }
+    }
+
+    hierarchical_barrier(hierarchical_barrier const&) = delete;
+    hierarchical_barrier& operator=(hierarchical_barrier const&) = delete;
+
+    ~hierarchical_barrier()
+    {
+        MPI_Win_unlock_all(m_win);
+        MPI_Win_free(&m_win);
+        if (m_leader_comm != MPI_COMM_NULL) MPI_Comm_free(&m_leader_comm);
+        MPI_Comm_free(&m_node_comm);
+    }
+
+    /** Synchronize all ranks, calling progress() while waiting. */
+    template<typename Progress>
+    void operator()(Progress&& progress)
+    {
+        arrive();
+        while (!test()) progress();
+    }
+
+    /** Start a new epoch. The previous epoch must have completed. */
+    void arrive()
+    {
+        ++m_epoch;
+        m_state->m_arrived.fetch_add(1u, std::memory_order_acq_rel);
+        if (m_leader_comm != MPI_COMM_NULL) m_phase = phase::gather;
+    }
+
+    /** Advance the current epoch without blocking, returns true once it has completed. */
+    bool test()
+    {
+        if (m_leader_comm == MPI_COMM_NULL)
+            return m_state->m_released.load(std::memory_order_acquire) >= m_epoch;
+
+        if (m_phase == phase::gather)
+        {
+            if (m_state->m_arrived.load(std::memory_order_acquire) < m_epoch * m_node_size)
+                return false;
+            m_phase = phase::exchange;
+            m_round = 0;
+            if (m_num_leaders > 1) post_round();
+        }
+
+        // dissemination: in round k, notify leader + 2^k and wait for leader - 2^k
+        while (m_phase == phase::exchange)
+        {
+            if ((1 << m_round) >= m_num_leaders)
+            {
+                m_state->m_released.store(m_epoch, std::memory_order_release);
+                m_phase = phase::done;
+                break;
+            }
+            int flag = 0;
+            OOMPH_CHECK_MPI_RESULT(MPI_Testall(2, m_reqs, &flag, MPI_STATUSES_IGNORE));
+            if (!flag) return false;
+            if ((1 << ++m_round) < m_num_leaders) post_round();
+        }
+        return true;
+    }
+
+  private:
+    static bool is_leader(int node_rank) noexcept { return node_rank == 0; }
+
+    void post_round()
+    {
+        int const d = 1 << m_round;
+        OOMPH_CHECK_MPI_RESULT(MPI_Irecv(nullptr, 0, MPI_BYTE,
+            (m_leader_rank + m_num_leaders - d) % m_num_leaders, m_round, m_leader_comm,
+            &m_reqs[0]));
+        OOMPH_CHECK_MPI_RESULT(MPI_Isend(nullptr, 0, MPI_BYTE, (m_leader_rank + d) % m_num_leaders,
+            m_round, m_leader_comm, &m_reqs[1]));
+    }
+};
+
+} // namespace oomph
@@ -0,0 +1,31 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <oomph/types.hpp>
+
+namespace oomph
+{
+// Tags of the messages which the library sends itself. They travel on the internal lane of the
+// backend (internal_send and internal_recv of the communicator), which is a matching space of its
+// own: receives of the user, even with any_tag, never match them, and the whole tag range is left
+// to the user. Internal tags are mapped into the tag range of the communicator like user tags, so
+// the internal messages of different tag ranges are kept apart as well.
+struct internal_tag
+{
+    // packets of active messages (see am_engine)
+    static constexpr tag_type am_packet = 0;
+    // credits of the flow control (see flow_control)
+    static constexpr tag_type credits = 1;
+    // the payloads of active messages take the remaining tags in turn
+    static constexpr tag_type am_payload = 2;
+};
+
+} // namespace oomph
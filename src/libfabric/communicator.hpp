@@ -11,6 +11,7 @@
 
 #include <cstdint>
 #include <stack>
+#include <stdexcept>
 
 #include <boost/lockfree/queue.hpp>
 
@@ -37,6 +38,8 @@ inline /*constexpr*/ NS_DEBUG::print_threshold<Level, 0> com_deb("COMMUNI");
 
 static NS_DEBUG::enable_print<false> com_err("COMMUNI");
 
+class remote_buffer_impl;
+
 class communicator_impl : public communicator_base<communicator_impl>
 {
     using tag_type = std::uint64_t;
@@ -80,14 +83,6 @@ class communicator_impl : public communicator_base<communicator_impl>
     void start_group() {}
     void end_group() {}
 
-    // --------------------------------------------------------------------
-    /// generate a tag with 0xRRRRRRRRtttttttt rank, tag.
-    /// original tag can be 32bits, then we add 32bits of rank info.
-    inline std::uint64_t make_tag64(std::uint32_t tag, /*std::uint32_t rank, */ std::uintptr_t ctxt)
-    {
-        return (((ctxt & 0x0000000000FFFFFF) << 24) | ((std::uint64_t(tag) & 0x0000000000FFFFFF)));
-    }
-
     // --------------------------------------------------------------------
     template<typename Func, typename... Args>
     inline void execute_fi_function(Func F, const char* msg, Args&&... args)
@@ -114,6 +109,10 @@ class communicator_impl : public communicator_base<communicator_impl>
         }
     }
 
+    // --------------------------------------------------------------------
+    // fabric address of a peer, which may be inserted into the address vector now
+    fi_addr_t peer_address(rank_type r) { return m_context->get_controller()->peer_address(r); }
+
     // --------------------------------------------------------------------
     // this takes a pinned memory region and sends it
     void send_tagged_region(region_type const& send_region, std::size_t size, fi_addr_t dst_addr_,
@@ -153,7 +152,7 @@ class communicator_impl : public communicator_base<communicator_impl>
     // itself as the context, so that when a message is received
     // the owning receiver is called to handle processing of the buffer
     void recv_tagged_region(region_type const& recv_region, std::size_t size, fi_addr_t src_addr_,
-        uint64_t tag_, operation_context* ctxt)
+        uint64_t tag_, uint64_t ignore, operation_context* ctxt)
     {
         [[maybe_unused]] auto scp = com_deb<9>.scope(NS_DEBUG::ptr(this), __func__);
         // clang-format off
@@ -165,19 +164,23 @@ class communicator_impl : public communicator_base<communicator_impl>
                   "context", NS_DEBUG::ptr(ctxt),
                   "rx endpoint", NS_DEBUG::ptr(m_rx_endpoint.get_ep())));
         // clang-format on
-        constexpr uint64_t ignore = 0;
         execute_fi_function(fi_trecv, "fi_trecv", m_rx_endpoint.get_ep(), recv_region.get_address(),
             size, recv_region.get_local_key(), src_addr_, tag_, ignore, ctxt);
         // if (l.owns_lock()) l.unlock();
     }
 
     // --------------------------------------------------------------------
+    // internal messages of the library are sent with the internal bit of the tag layout, which
+    // keeps them apart from the user messages, and bypass the loopback queue
     send_request send(context_impl::heap_type::pointer const& ptr, std::size_t size, rank_type dst,
         oomph::tag_type tag, util::unique_function<void(rank_type, oomph::tag_type)>&& cb,
-        std::size_t* scheduled, [[maybe_unused]] void* stream)
+        std::size_t* scheduled, [[maybe_unused]] void* stream, bool internal = false)
     {
+        if (!internal && is_loopback(dst, ptr))
+            return send_loopback(ptr, size, dst, tag, std::move(cb), scheduled);
         [[maybe_unused]] auto scp = com_deb<9>.scope(NS_DEBUG::ptr(this), __func__);
-        std::uint64_t stag = make_tag64(tag, /*this->rank(), */ this->m_context->get_context_tag());
+        auto const&           layout = this->m_context->get_tag_layout();
+        std::uint64_t         stag = layout.encode(m_tag_range.map(tag), this->rank(), internal);
 
 #if OOMPH_ENABLE_DEVICE
         auto const& reg = ptr.on_device() ? ptr.device_handle() : ptr.handle();
@@ -195,9 +198,9 @@ class communicator_impl : public communicator_base<communicator_impl>
         m_context->get_controller()->sends_posted_++;
 
         // use optimized inject if msg is very small
-        if (size <= m_context->get_controller()->get_tx_inject_size())
+        if (size <= m_context->get_inject_size())
         {
-            inject_tagged_region(reg, size, fi_addr_t(dst), stag);
+            inject_tagged_region(reg, size, peer_address(dst), stag);
             if (!has_reached_recursion_depth())
             {
                 auto inc = recursion();
@@ -241,16 +244,27 @@ class communicator_impl : public communicator_base<communicator_impl>
 #endif
         // clang-format on
 
-        send_tagged_region(reg, size, fi_addr_t(dst), stag, &(s->m_operation_context));
+        send_tagged_region(reg, size, peer_address(dst), stag, &(s->m_operation_context));
         return {std::move(s)};
     }
 
+    // wire tag of a receive: any_tag matches the tags of the tag range of this communicator only
+    // (see tag_layout::ignore)
+    oomph::tag_type recv_tag(oomph::tag_type tag) const noexcept
+    {
+        return tag == communicator::any_tag ? m_tag_range.offset() : m_tag_range.map(tag);
+    }
+
     recv_request recv(context_impl::heap_type::pointer& ptr, std::size_t size, rank_type src,
         oomph::tag_type tag, util::unique_function<void(rank_type, oomph::tag_type)>&& cb,
-        std::size_t* scheduled, [[maybe_unused]] void* stream)
+        std::size_t* scheduled, [[maybe_unused]] void* stream, bool internal = false)
     {
+        if (!internal && is_loopback(src, ptr))
+            return recv_loopback(ptr, size, src, tag, std::move(cb), scheduled);
         [[maybe_unused]] auto scp = com_deb<9>.scope(NS_DEBUG::ptr(this), __func__);
-        std::uint64_t         stag = make_tag64(tag, /*src, */ this->m_context->get_context_tag());
+        auto const&           layout = this->m_context->get_tag_layout();
+        std::uint64_t         stag = layout.encode(recv_tag(tag), src, internal);
+        std::uint64_t const   ignore = layout.ignore(tag, src, m_tag_range.max_tag());
 
 #if OOMPH_ENABLE_DEVICE
         auto const& reg = ptr.on_device() ? ptr.device_handle() : ptr.handle();
@@ -293,18 +307,36 @@ class communicator_impl : public communicator_base<communicator_impl>
 #endif
         // clang-format on
 
-        recv_tagged_region(reg, size, fi_addr_t(src), stag, &(s->m_operation_context));
+        recv_tagged_region(reg, size, peer_address(src), stag, ignore, &(s->m_operation_context));
         return {std::move(s)};
     }
 
+    send_request internal_send(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        rank_type dst, oomph::tag_type tag,
+        util::unique_function<void(rank_type, oomph::tag_type)>&& cb, std::size_t* scheduled)
+    {
+        return send(ptr, size, dst, tag, std::move(cb), scheduled, nullptr, true);
+    }
+
+    recv_request internal_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
+        rank_type src, oomph::tag_type tag,
+        util::unique_function<void(rank_type, oomph::tag_type)>&& cb, std::size_t* scheduled)
+    {
+        return recv(ptr, size, src, tag, std::move(cb), scheduled, nullptr, true);
+    }
+
     shared_recv_request shared_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
         rank_type src, oomph::tag_type tag,
         util::unique_function<void(rank_type, oomph::tag_type)>&& cb,
         std::atomic<std::size_t>*                                 scheduled,
         [[maybe_unused]] void* stream)
     {
+        if (is_loopback(src, ptr))
+            return shared_recv_loopback(ptr, size, src, tag, std::move(cb), scheduled);
         [[maybe_unused]] auto scp = com_deb<9>.scope(NS_DEBUG::ptr(this), __func__);
-        std::uint64_t         stag = make_tag64(tag, /*src, */ this->m_context->get_context_tag());
+        auto const&           layout = this->m_context->get_tag_layout();
+        std::uint64_t         stag = layout.encode(recv_tag(tag), src);
+        std::uint64_t const   ignore = layout.ignore(tag, src, m_tag_range.max_tag());
 
 #if OOMPH_ENABLE_DEVICE
         auto const& reg = ptr.on_device() ? ptr.device_handle() : ptr.handle();
@@ -341,13 +373,39 @@ class communicator_impl : public communicator_base<communicator_impl>
                   "req", NS_DEBUG::ptr(s.get())));
         // clang-format on
 
-        recv_tagged_region(reg, size, fi_addr_t(src), stag, &(s->m_operation_context));
+        recv_tagged_region(reg, size, peer_address(src), stag, ignore, &(s->m_operation_context));
         m_context->get_controller()->poll_recv_queue(m_rx_endpoint.get_rx_cq(), this);
         return {std::move(s)};
     }
 
+    // --------------------------------------------------------------------
+    // request states of the operations matched by the loopback queue
+    auto make_loopback_state(std::size_t* scheduled, rank_type rank, oomph::tag_type tag,
+        cb_type&& cb)
+    {
+        return m_req_state_factory.make(m_context, this, scheduled, rank, tag, std::move(cb));
+    }
+
+    auto make_loopback_shared_state(std::atomic<std::size_t>* scheduled, rank_type rank,
+        oomph::tag_type tag, cb_type&& cb)
+    {
+        return std::make_shared<detail::shared_request_state>(m_context, this, scheduled, rank,
+            tag, std::move(cb));
+    }
+
+    // --------------------------------------------------------------------
+    // one-sided operations: defined in rma.hpp
+    rma_request put(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        remote_buffer_impl const& dst, std::size_t offset, std::size_t* scheduled);
+
+    rma_request get(context_impl::heap_type::pointer& ptr, std::size_t size,
+        remote_buffer_impl const& src, std::size_t offset, std::size_t* scheduled);
+
+    void flush(remote_buffer_impl const& dst);
+
     void progress()
     {
+        progress_loopback();
         m_context->get_controller()->poll_for_work_completions(this);
         clear_callback_queues();
     }
@@ -381,6 +439,14 @@ class communicator_impl : public communicator_base<communicator_impl>
             });
     }
 
+    // receives of unknown size are not supported: they would need FI_PEEK/FI_CLAIM and FI_SOURCE,
+    // which not all providers support (see the README)
+    template<typename CallBack>
+    recv_request recv_any_size(rank_type, oomph::tag_type, CallBack&&, std::size_t*)
+    {
+        throw std::runtime_error("oomph libfabric backend: recv_any_size is not supported");
+    }
+
     // Cancel is a problem with libfabric because fi_cancel is asynchronous.
     // The item to be cancelled will either complete with CANCELLED status
     // or will complete as usual (ie before the cancel could take effect)
@@ -390,6 +456,8 @@ class communicator_impl : public communicator_base<communicator_impl>
     // by oomph.
     bool cancel_recv(detail::request_state* s)
     {
+        if (s->m_loopback) return cancel_loopback(s);
+
         // get the original message operation context
         operation_context* op_ctx = &(s->m_operation_context);
 
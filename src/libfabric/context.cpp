@@ -50,6 +50,10 @@ context_impl::context_impl(MPI_Comm comm, bool thread_safe,
     int threads = boost::thread::physical_concurrency();
     m_controller = init_libfabric_controller(this, comm, rank, size, threads);
     m_domain = m_controller->get_domain();
+    m_inject_size = m_controller->get_tx_inject_size();
+    if (m_thresholds.inject() > 0u) m_inject_size = std::min(m_inject_size, m_thresholds.inject());
+    m_inject_str = std::to_string(m_inject_size);
+    m_tag_layout = libfabric::tag_layout(m_controller->tag_format_bits(), m_ctxt_tag, size);
 }
 
 communicator_impl*
@@ -73,6 +77,8 @@ context_impl::get_transport_option(const std::string& opt) const
         strncpy(buffer, temp.c_str(), std::min(size_t(31), std::strlen(temp.c_str())));
         return buffer;
     }
+    else if (opt == "inject_threshold") { return m_inject_str.c_str(); }
+    else if (opt == "tag_layout") { return m_tag_layout.c_str(); }
     else { return "unspecified"; }
 }
 
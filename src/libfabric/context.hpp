@@ -11,6 +11,7 @@
 
 #include <thread>
 #include <stack>
+#include <string>
 
 #include <hwmalloc/heap.hpp>
 #include <hwmalloc/heap_config.hpp>
@@ -23,6 +24,7 @@
 #include <memory_region.hpp>
 #include <controller.hpp>
 #include <request_state.hpp>
+#include <tag_layout.hpp>
 
 namespace oomph
 {
@@ -46,6 +48,10 @@ class context_impl : public context_base
     domain_type*                     m_domain;
     std::shared_ptr<controller_type> m_controller;
     std::uintptr_t                   m_ctxt_tag;
+    // largest injected message: limited by the provider and by OOMPH_INJECT_THRESHOLD
+    std::size_t                      m_inject_size;
+    std::string                      m_inject_str;
+    libfabric::tag_layout            m_tag_layout;
 
   public:
     // --------------------------------------------------
@@ -82,12 +88,23 @@ class context_impl : public context_base
     inline std::uintptr_t get_context_tag() { return m_ctxt_tag; }
 
     inline controller_type* get_controller() /*const */ { return m_controller.get(); }
+
+    std::size_t get_inject_size() const noexcept { return m_inject_size; }
+
+    libfabric::tag_layout const& get_tag_layout() const noexcept { return m_tag_layout; }
     const char*             get_transport_option(const std::string& opt) const;
 
-    void progress() { get_controller()->poll_for_work_completions(nullptr); }
+    void progress()
+    {
+        m_loopback.progress_any_source(m_any_source, rank());
+        m_loopback.progress_shared();
+        get_controller()->poll_for_work_completions(nullptr);
+    }
 
     bool cancel_recv(detail::shared_request_state* s)
     {
+        if (s->m_loopback) return m_loopback.cancel(s) || m_any_source.cancel(s);
+
         // get the original message operation context
         auto op_ctx = &(s->m_operation_context);
 
@@ -133,7 +150,8 @@ class context_impl : public context_base
         return found;
     }
 
-    unsigned int num_tag_bits() const noexcept { return 32; }
+    // user tags occupy the lower bits of the 64 bit libfabric tag (see tag_layout)
+    unsigned int num_tag_bits() const noexcept { return m_tag_layout.tag_bits(); }
 };
 
 // --------------------------------------------------------------------
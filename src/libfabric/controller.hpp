@@ -43,6 +43,7 @@
 #include "controller_base.hpp"
 //
 #include <oomph/util/unique_function.hpp>
+#include <oomph/util/mpi_error.hpp>
 //
 #include <mpi.h>
 
@@ -104,74 +105,34 @@ class controller : public controller_base<controller>
     void setup_root_node_address(struct fi_info* /*info*/) {}
 
     // --------------------------------------------------------------------
-    // send address to rank 0 and receive array of all localities
-    void MPI_exchange_localities(fid_av* av, MPI_Comm comm, int rank, int size)
+    // gather the addresses of all ranks on all ranks and insert them into the address vector in
+    // one batch, or only keep them if peers are inserted on first contact (see peer_address)
+    void MPI_exchange_localities(fid_av* av, MPI_Comm comm, int /*rank*/, int size)
     {
         [[maybe_unused]] auto scp = NS_DEBUG::cnt_deb<9>.scope(NS_DEBUG::ptr(this), __func__);
-        std::vector<char>     localities(size * locality_defs::array_size, 0);
-        //
-        if (rank > 0)
+        localities_.assign(size * locality_defs::array_size, 0);
+        LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("gathering addresses"), iplocality(here_),
+                                         "size", locality_defs::array_size));
+        OOMPH_CHECK_MPI_RESULT(MPI_Allgather(here_.fabric_data(), locality_defs::array_size,
+            MPI_CHAR, localities_.data(), locality_defs::array_size, MPI_CHAR, comm));
+
+        fi_addrs_.reset(new std::atomic<fi_addr_t>[size]);
+        if (lazy_av_)
         {
-            LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("sending here"), iplocality(here_),
-                                             "size", locality_defs::array_size));
-            /*int err = */ MPI_Send(here_.fabric_data(), locality_defs::array_size, MPI_CHAR,
-                0, // dst rank
-                0, // tag
-                comm);
-
-            LF_DEB(NS_DEBUG::cnt_deb<9>,
-                debug(debug::str<>("receiving all"), "size", locality_defs::array_size));
-
-            MPI_Status status;
-            /*err = */ MPI_Recv(localities.data(), size * locality_defs::array_size, MPI_CHAR,
-                0, // src rank
-                0, // tag
-                comm, &status);
-            LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("received addresses")));
+            for (int i = 0; i < size; ++i) fi_addrs_[i].store(FI_ADDR_NOTAVAIL);
+            return;
         }
-        else
-        {
-            LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("receiving addresses")));
-            memcpy(&localities[0], here_.fabric_data(), locality_defs::array_size);
-            for (int i = 1; i < size; ++i)
-            {
-                LF_DEB(NS_DEBUG::cnt_deb<9>,
-                    debug(debug::str<>("receiving address"), debug::dec<>(i)));
-                MPI_Status status;
-                /*int err = */ MPI_Recv(&localities[i * locality_defs::array_size],
-                    size * locality_defs::array_size, MPI_CHAR,
-                    i, // src rank
-                    0, // tag
-                    comm, &status);
-                LF_DEB(NS_DEBUG::cnt_deb<9>,
-                    debug(debug::str<>("received address"), debug::dec<>(i)));
-            }
 
-            LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("sending all")));
-            for (int i = 1; i < size; ++i)
-            {
-                LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("sending to"), debug::dec<>(i)));
-                /*int err = */ MPI_Send(&localities[0], size * locality_defs::array_size, MPI_CHAR,
-                    i, // dst rank
-                    0, // tag
-                    comm);
-            }
-        }
-
-        // all ranks should now have a full localities vector
+        // all ranks now have the full localities vector
         LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("populating vector")));
-        for (int i = 0; i < size; ++i)
-        {
-            locality temp;
-            int      offset = i * locality_defs::array_size;
-            memcpy(temp.fabric_data_writable(), &localities[offset], locality_defs::array_size);
-            insert_address(av, temp);
-        }
+        std::vector<fi_addr_t> fi_addrs(size, FI_ADDR_NOTAVAIL);
+        insert_addresses(av, localities_.data(), size, fi_addrs.data());
+        for (int i = 0; i < size; ++i) fi_addrs_[i].store(fi_addrs[i]);
     }
 
     // --------------------------------------------------------------------
     // if we did not bootstrap, then fetch the list of all localities
-    // and insert each one into the address vector
+    // and insert them into the address vector
     void exchange_addresses(fid_av* av, MPI_Comm mpi_comm)
     {
         [[maybe_unused]] auto scp = NS_DEBUG::cnt_deb<9>.scope(NS_DEBUG::ptr(this), __func__);
@@ -183,11 +144,40 @@ class controller : public controller_base<controller>
         LF_DEB(NS_DEBUG::cnt_deb<9>,
             debug(debug::str<>("initialize_localities"), size, "localities"));
 
+        lazy_av_ = libfabric_lazy_av();
         MPI_exchange_localities(av, mpi_comm, rank, size);
-        debug_print_av_vector(size);
+        if (!lazy_av_) debug_print_av_vector(size);
         LF_DEB(NS_DEBUG::cnt_deb<9>, debug(debug::str<>("Done localities")));
     }
 
+    // --------------------------------------------------------------------
+    // fabric address of a rank, FI_ADDR_UNSPEC for any source: with LIBFABRIC_LAZY_AV=1 the
+    // address is inserted into the address vector when the rank is first contacted
+    fi_addr_t peer_address(int rank)
+    {
+        if (rank < 0) return FI_ADDR_UNSPEC;
+        auto const addr = fi_addrs_[rank].load(std::memory_order_acquire);
+        if (addr != FI_ADDR_NOTAVAIL) return addr;
+
+        std::lock_guard<std::mutex> lock(av_mutex_);
+        if (fi_addrs_[rank].load(std::memory_order_relaxed) == FI_ADDR_NOTAVAIL)
+        {
+            fi_addr_t new_addr = FI_ADDR_NOTAVAIL;
+            insert_addresses(av_, &localities_[rank * locality_defs::array_size], 1, &new_addr);
+            fi_addrs_[rank].store(new_addr, std::memory_order_release);
+        }
+        return fi_addrs_[rank].load(std::memory_order_relaxed);
+    }
+
+  private:
+    // addresses of all ranks, as gathered from the MPI communicator
+    std::vector<char> localities_;
+    // fabric addresses by rank, FI_ADDR_NOTAVAIL until inserted
+    std::unique_ptr<std::atomic<fi_addr_t>[]> fi_addrs_;
+    std::mutex                                av_mutex_;
+    bool                                      lazy_av_ = false;
+
+  public:
     // --------------------------------------------------------------------
     inline constexpr bool bypass_tx_lock()
     {
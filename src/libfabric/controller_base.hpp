@@ -45,6 +45,9 @@
 #include "memory_region.hpp"
 #include "operation_context_base.hpp"
 
+// paths relative to backend
+#include <../thresholds.hpp>
+
 //#define DISABLE_FI_INJECT
 //#define EXCESSIVE_POLLING_BACKOFF_MICRO_S 50
 
@@ -148,9 +151,12 @@ libfabric_completions_per_poll()
 // ----------------------------------------
 // Eager/Rendezvous threshold
 // ----------------------------------------
+// OOMPH_RNDV_THRESHOLD (see thresholds) takes precedence, but the controller is shared by all
+// contexts of the process: the first context sets it
 static int
 libfabric_rendezvous_threshold(int def_val)
 {
+    if (auto const rndv = oomph::profile_getenv("OOMPH_RNDV_THRESHOLD", 0u)) return rndv;
     auto env_str = std::getenv("LIBFABRIC_RENDEZVOUS_THRESHOLD");
     if (env_str != nullptr)
     {
@@ -166,6 +172,16 @@ libfabric_rendezvous_threshold(int def_val)
     return def_val;
 }
 
+// ----------------------------------------
+// insert peers into the address vector on first contact
+// ----------------------------------------
+static bool
+libfabric_lazy_av()
+{
+    auto env_str = std::getenv("LIBFABRIC_LAZY_AV");
+    return (env_str != nullptr) && (std::string(env_str) != "0");
+}
+
 // ------------------------------------------------
 // Needed on Cray for GNI extensions
 // ------------------------------------------------
@@ -1289,6 +1305,22 @@ class controller_base
     inline std::size_t get_tx_inject_size() { return tx_inject_size_; }
 #endif
 
+    // --------------------------------------------------------------------
+    // number of tag bits the provider matches: the width of mem_tag_format up to its most
+    // significant bit, all 64 bits if the provider does not restrict the format
+    inline unsigned int tag_format_bits() const
+    {
+        std::uint64_t format = fabric_info_->ep_attr->mem_tag_format;
+        if (format == 0u) return 64u;
+        unsigned int bits = 0u;
+        while (format != 0u)
+        {
+            format >>= 1;
+            ++bits;
+        }
+        return bits;
+    }
+
     // --------------------------------------------------------------------
     inline std::size_t get_tx_size() { return tx_attr_size_; }
 
@@ -1473,6 +1505,24 @@ class controller_base
     // --------------------------------------------------------------------
     locality insert_address(const locality& address) { return insert_address(av_, address); }
 
+    // --------------------------------------------------------------------
+    // insert count addresses (stored back to back) with a single call: the fabric address of the
+    // i-th one is returned in fi_addrs[i]
+    void insert_addresses(fid_av* av, const char* addresses, std::size_t count, fi_addr_t* fi_addrs)
+    {
+        [[maybe_unused]] auto scp = NS_DEBUG::cnb_deb.scope(NS_DEBUG::ptr(this), __func__);
+
+        LF_DEB(NS_DEBUG::cnb_deb,
+            trace(debug::str<>("inserting AV"), debug::dec<>(count), NS_DEBUG::ptr(av)));
+        int ret = fi_av_insert(av, addresses, count, fi_addrs, 0, nullptr);
+        if (ret < 0) { throw NS_LIBFABRIC::fabric_error(ret, "fi_av_insert"); }
+        else if (std::size_t(ret) != count)
+        {
+            throw NS_LIBFABRIC::fabric_error(-FI_EOTHER,
+                "fi_av_insert did not insert all addresses");
+        }
+    }
+
     // --------------------------------------------------------------------
     locality insert_address(fid_av* av, const locality& address)
     {
@@ -0,0 +1,155 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include <oomph/types.hpp>
+
+namespace oomph::libfabric
+{
+// ----------------------------------------
+// width of a field of the tag layout
+// ----------------------------------------
+static unsigned int
+libfabric_tag_field_bits(const char* env_name, unsigned int def_val)
+{
+    auto env_str = std::getenv(env_name);
+    if (env_str != nullptr)
+    {
+        char* end;
+        return std::strtoul(env_str, &end, 0);
+    }
+    return def_val;
+}
+
+static bool
+libfabric_tag_hash()
+{
+    auto env_str = std::getenv("LIBFABRIC_TAG_HASH");
+    return (env_str != nullptr) && (std::string(env_str) != "0");
+}
+
+// Layout of the 64 bit libfabric tag, from the least significant bit: the (mapped) user tag, a bit
+// which marks the internal messages of the library, the rank of the sender (optional) and the
+// context id, which keeps the messages of contexts apart that share the endpoints of the process.
+// The width of the context field is what is left of the bits the provider matches (see
+// controller_base::tag_format_bits). The context id is truncated to its field, or hashed into it.
+// Tags which do not fit into their field are rejected. Receives from any source (if the rank is
+// encoded) and with any tag ignore the respective fields, but never the internal bit. Receives are
+// not matched on the address of the sender (no FI_DIRECTED_RECV): without the rank field, a
+// receive from one rank may take the message of another rank with the same tag.
+//
+// Configured through the environment (identically on all ranks):
+//   LIBFABRIC_TAG_BITS=<n>         bits of the user tag (default: 31, the non-negative tags)
+//   LIBFABRIC_RANK_TAG_BITS=<n>    bits of the sender rank (default: as many as the ranks need,
+//                                  or 0 if they do not fit)
+//   LIBFABRIC_TAG_HASH=1           hash the context id instead of truncating it
+class tag_layout
+{
+  private:
+    unsigned int  m_tag_bits = 24u;
+    unsigned int  m_rank_bits = 0u;
+    unsigned int  m_ctxt_bits = 23u;
+    std::uint64_t m_tag_mask = mask(24u);
+    std::uint64_t m_internal = std::uint64_t(1) << 24u;
+    std::uint64_t m_rank_mask = 0u;
+    std::uint64_t m_ctxt = 0u;
+    std::string   m_str;
+
+  public:
+    tag_layout() = default;
+
+    // available_bits: bits the provider matches, ctxt_id: the same on all ranks, size: number of
+    // ranks
+    tag_layout(unsigned int available_bits, std::uint64_t ctxt_id, rank_type size)
+    : m_tag_bits{libfabric_tag_field_bits("LIBFABRIC_TAG_BITS", 31u)}
+    , m_rank_bits{libfabric_tag_field_bits("LIBFABRIC_RANK_TAG_BITS",
+          rank_bits(size, available_bits > m_tag_bits ? available_bits - m_tag_bits - 1u : 0u))}
+    {
+        if (m_tag_bits == 0u || m_tag_bits > 31u)
+            throw std::runtime_error("oomph: libfabric tag bits must be in [1, 31]");
+        if (m_tag_bits + 1u + m_rank_bits > available_bits)
+            throw std::runtime_error("oomph: libfabric tag layout needs " +
+                                     std::to_string(m_tag_bits + 1u + m_rank_bits) +
+                                     " bits, the provider matches " +
+                                     std::to_string(available_bits));
+        if (m_rank_bits > 0u && m_rank_bits < 32u &&
+            ((std::uint64_t)(size - 1) >> m_rank_bits) != 0u)
+            throw std::runtime_error("oomph: too many ranks for the libfabric rank tag bits");
+        m_ctxt_bits = available_bits - m_tag_bits - 1u - m_rank_bits;
+        m_tag_mask = mask(m_tag_bits);
+        m_internal = std::uint64_t(1) << m_tag_bits;
+        m_rank_mask = mask(m_rank_bits) << (m_tag_bits + 1u);
+        auto const id = libfabric_tag_hash() ? hash(ctxt_id) : ctxt_id;
+        if (m_ctxt_bits > 0u) m_ctxt = (id & mask(m_ctxt_bits)) << (m_tag_bits + 1u + m_rank_bits);
+        m_str = "tag:" + std::to_string(m_tag_bits) + ",internal:1,rank:" +
+                std::to_string(m_rank_bits) + ",context:" + std::to_string(m_ctxt_bits);
+    }
+
+  public:
+    unsigned int tag_bits() const noexcept { return m_tag_bits; }
+    const char*  c_str() const noexcept { return m_str.c_str(); }
+
+    // tag of a message with the (mapped) tag from rank, which may be any_tag and any_source for
+    // receives, and which is an internal message of the library if internal is set
+    std::uint64_t encode(tag_type tag, rank_type rank, bool internal = false) const
+    {
+        std::uint64_t t = m_ctxt | (internal ? m_internal : 0u);
+        if (tag >= 0)
+        {
+            if (((std::uint64_t)tag & ~m_tag_mask) != 0u)
+                throw std::runtime_error("oomph: tag " + std::to_string(tag) +
+                                         " exceeds the libfabric tag bits");
+            t |= (std::uint64_t)tag;
+        }
+        if (m_rank_bits > 0u && rank >= 0)
+            t |= ((std::uint64_t)rank << (m_tag_bits + 1u)) & m_rank_mask;
+        return t;
+    }
+
+    // bits a receive with tag (or any_tag) from rank (or any_source) does not match: any_tag
+    // ignores the tag bits in range_bits only (those of the tag range of the communicator)
+    std::uint64_t ignore(tag_type tag, rank_type rank, tag_type range_bits) const noexcept
+    {
+        return (tag < 0 ? ((std::uint64_t)range_bits & m_tag_mask) : 0u) |
+               (rank < 0 ? m_rank_mask : 0u);
+    }
+
+  private:
+    // bits of the ranks [0, size), or 0 if they do not fit into free_bits
+    static unsigned int rank_bits(rank_type size, unsigned int free_bits) noexcept
+    {
+        unsigned int bits = 0u;
+        while (bits < 32u && ((std::uint64_t)(size - 1) >> bits) != 0u) ++bits;
+        return bits <= free_bits ? bits : 0u;
+    }
+
+    static std::uint64_t mask(unsigned int bits) noexcept
+    {
+        return bits >= 64u ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1u;
+    }
+
+    // spreads the bits of the id (e.g. an aligned pointer) over the whole word
+    static std::uint64_t hash(std::uint64_t x) noexcept
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+};
+
+} // namespace oomph::libfabric
@@ -0,0 +1,419 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <oomph/types.hpp>
+
+namespace oomph
+{
+// ----------------------------------------
+// loopback matching of messages to self
+// ----------------------------------------
+static bool
+loopback_enabled()
+{
+    auto env_str = std::getenv("OOMPH_LOOPBACK");
+    return (env_str == nullptr) || (std::string(env_str) != "0");
+}
+
+// ----------------------------------------
+// largest message to self which is buffered
+// ----------------------------------------
+static std::size_t
+loopback_eager_limit()
+{
+    auto env_str = std::getenv("OOMPH_LOOPBACK_EAGER_LIMIT");
+    if (env_str != nullptr)
+    {
+        char* end;
+        return std::strtoull(env_str, &end, 0);
+    }
+    return 65536u;
+}
+
+// Matches the messages a process sends to itself, bypassing the transport. There is one queue per
+// context, so messages are also matched between the communicators of a context (i.e. between
+// threads), as long as they share the tag range. Messages are matched in order per tag, and any_tag
+// receives match any tag of their range; receives from any_source take the messages to self out of
+// this queue through take (see any_source_queue).
+//
+// A send is copied into the buffer of the oldest matching receive and completes immediately. If no
+// receive is posted yet, it is buffered (and completes immediately) up to the eager limit, while
+// larger messages stay in the user's buffer and are copied once, when the receive is posted: such
+// a send only completes after the matching receive has been posted. Requests which are matched
+// after they were posted are handed to the mailbox of the communicator which posted them, and
+// their callbacks are invoked when that communicator progresses. Shared receives are completed by
+// the progress of any communicator of the context. A message which is larger than the receive it
+// matches is an error: it throws before anything is copied, and the message and the receive stay
+// where they are.
+//
+// Configured through the environment:
+//   OOMPH_LOOPBACK=0                   messages to self go through the transport
+//   OOMPH_LOOPBACK_EAGER_LIMIT=<n>     largest buffered message in bytes (default: 65536)
+template<typename State, typename SharedState>
+class loopback_queue
+{
+  public:
+    // ready requests of one communicator
+    struct mailbox
+    {
+        std::vector<State*>      m_ready;
+        std::vector<State*>      m_work;
+        std::atomic<std::size_t> m_size{0u};
+        bool                     m_in_progress = false;
+    };
+
+  private:
+    using lock_type = std::unique_lock<std::mutex>;
+
+    // buffered message, or the user's buffer of a pending send
+    struct message
+    {
+        unsigned int      m_range;
+        tag_type          m_tag;
+        std::vector<char> m_data;
+        void const*       m_ptr = nullptr;
+        std::size_t       m_size = 0u;
+        State*            m_state = nullptr;
+        mailbox*          m_mailbox = nullptr;
+    };
+
+    struct posted_recv
+    {
+        unsigned int m_range;
+        tag_type     m_tag;
+        void*        m_ptr;
+        std::size_t  m_size;
+        State*       m_state;
+        SharedState* m_shared_state;
+        mailbox*     m_mailbox;
+    };
+
+  private:
+    bool const                     m_enabled;
+    std::size_t const              m_eager_limit;
+    bool const                     m_thread_safe;
+    std::mutex                     m_mutex;
+    std::deque<message>            m_messages;
+    std::atomic<std::size_t>       m_num_messages{0u};
+    std::deque<posted_recv>        m_recvs;
+    std::vector<std::vector<char>> m_free_buffers;
+    std::vector<SharedState*>      m_shared_ready;
+    std::atomic<std::size_t>       m_shared_size{0u};
+
+  public:
+    loopback_queue(bool thread_safe)
+    : m_enabled{loopback_enabled()}
+    , m_eager_limit{loopback_eager_limit()}
+    , m_thread_safe{thread_safe}
+    {
+    }
+
+    loopback_queue(loopback_queue const&) = delete;
+
+  public:
+    bool enabled() const noexcept { return m_enabled; }
+
+    // whether any message is waiting for its receive (without locking)
+    bool has_messages() const noexcept { return m_num_messages.load() > 0u; }
+
+    bool has_message(unsigned int range, tag_type tag)
+    {
+        auto lk = lock();
+        return std::any_of(m_messages.begin(), m_messages.end(),
+            [range, tag](auto const& m) { return matches(range, tag, m.m_range, m.m_tag); });
+    }
+
+    // deliver a message to a posted receive or buffer it: returns true if the send has completed,
+    // otherwise it is kept pending with the state returned by make_state
+    template<typename MakeState>
+    bool send(unsigned int range, tag_type tag, void const* ptr, std::size_t size, mailbox& mb,
+        MakeState&& make_state)
+    {
+        auto lk = lock();
+        auto it = std::find_if(m_recvs.begin(), m_recvs.end(),
+            [range, tag](auto const& r) { return matches(r.m_range, r.m_tag, range, tag); });
+        if (it == m_recvs.end())
+        {
+            if (size <= m_eager_limit)
+            {
+                m_messages.push_back(message{range, tag, make_buffer(ptr, size)});
+                ++m_num_messages;
+                return true;
+            }
+            m_messages.push_back(message{range, tag, {}, ptr, size, make_state(), &mb});
+            ++m_num_messages;
+            return false;
+        }
+        check_size(size, it->m_size);
+        std::memcpy(it->m_ptr, ptr, size);
+        auto const r = *it;
+        m_recvs.erase(it);
+        if (r.m_state) push(*r.m_mailbox, r.m_state);
+        else
+            push_shared(r.m_shared_state);
+        return true;
+    }
+
+    // match a receive against the buffered messages: returns true if a message was copied,
+    // otherwise the receive is posted with the state returned by make_state
+    template<typename MakeState>
+    bool recv(unsigned int range, tag_type tag, void* ptr, std::size_t size, mailbox& mb,
+        MakeState&& make_state)
+    {
+        auto lk = lock();
+        if (match_message(range, tag, ptr, size)) return true;
+        m_recvs.push_back(posted_recv{range, tag, ptr, size, make_state(), nullptr, &mb});
+        return false;
+    }
+
+    template<typename MakeState>
+    bool shared_recv(unsigned int range, tag_type tag, void* ptr, std::size_t size,
+        MakeState&& make_state)
+    {
+        auto lk = lock();
+        if (match_message(range, tag, ptr, size)) return true;
+        m_recvs.push_back(posted_recv{range, tag, ptr, size, nullptr, make_state(), nullptr});
+        return false;
+    }
+
+    // match a receive of unknown size against the buffered messages: allocate is called with the
+    // size of the oldest matching message and returns the buffer it is copied into. Returns false
+    // if there is no such message; otherwise the size and the tag of the message are stored.
+    template<typename Allocate>
+    bool take(unsigned int range, tag_type tag, std::size_t& size, tag_type& msg_tag,
+        Allocate&& allocate)
+    {
+        auto lk = lock();
+        auto it = std::find_if(m_messages.begin(), m_messages.end(),
+            [range, tag](auto const& m) { return matches(range, tag, m.m_range, m.m_tag); });
+        if (it == m_messages.end()) return false;
+        size = it->m_state ? it->m_size : it->m_data.size();
+        msg_tag = it->m_tag;
+        return match_message(range, tag, allocate(size), size);
+    }
+
+    // match a receive into ptr with capacity bytes against the buffered messages, see take
+    bool take(unsigned int range, tag_type tag, void* ptr, std::size_t capacity, std::size_t& size,
+        tag_type& msg_tag)
+    {
+        return take(range, tag, size, msg_tag,
+            [ptr, capacity](std::size_t n)
+            {
+                check_size(n, capacity);
+                return ptr;
+            });
+    }
+
+    // defer the callback of a request which completed immediately (recursion depth reached)
+    void deliver(mailbox& mb, State* s)
+    {
+        auto lk = lock();
+        push(mb, s);
+    }
+
+    void deliver_shared(SharedState* s)
+    {
+        auto lk = lock();
+        push_shared(s);
+    }
+
+    // hand the waiting messages to the receives from any source of q (see any_source_queue), whose
+    // callbacks are invoked by the progress of mb, or as shared receives
+    template<typename Queue>
+    void progress_any_source(Queue& q, rank_type rank, mailbox* mb = nullptr)
+    {
+        if (q.empty() || !has_messages()) return;
+        q.progress([this](unsigned int range, tag_type tag) { return has_message(range, tag); },
+            [this, rank, mb](unsigned int range, tag_type tag, void* ptr, std::size_t capacity,
+                auto* s)
+            {
+                std::size_t size;
+                tag_type    msg_tag;
+                if (!take(range, tag, ptr, capacity, size, msg_tag)) return false;
+                s->m_rank = rank;
+                s->m_tag = msg_tag;
+                auto lk = lock();
+                if constexpr (std::is_same_v<std::remove_pointer_t<decltype(s)>, SharedState>)
+                    push_shared(s);
+                else
+                    push(*mb, s);
+                return true;
+            });
+    }
+
+    // cancel a posted receive: returns false if it was matched already
+    template<typename S>
+    bool cancel(S* s)
+    {
+        {
+            auto lk = lock();
+            auto it = std::find_if(m_recvs.begin(), m_recvs.end(), [s](auto const& r)
+                { return (void*)r.m_state == s || (void*)r.m_shared_state == s; });
+            if (it == m_recvs.end()) return false;
+            m_recvs.erase(it);
+        }
+        auto ptr = s->release_self_ref();
+        s->set_canceled();
+        return true;
+    }
+
+    // invoke the callbacks of the ready requests of a communicator
+    int progress(mailbox& mb)
+    {
+        if (mb.m_in_progress || mb.m_size.load() == 0u) return 0;
+        mb.m_in_progress = true;
+        {
+            auto lk = lock();
+            mb.m_work.swap(mb.m_ready);
+            mb.m_size = 0u;
+        }
+        int const completed = mb.m_work.size();
+        for (auto s : mb.m_work)
+        {
+            auto ptr = s->release_self_ref();
+            s->invoke_cb();
+        }
+        mb.m_work.clear();
+        mb.m_in_progress = false;
+        return completed;
+    }
+
+    // invoke the callbacks of the ready shared receives
+    int progress_shared()
+    {
+        static thread_local bool                      in_progress = false;
+        static thread_local std::vector<SharedState*> work;
+        if (in_progress || m_shared_size.load() == 0u) return 0;
+        in_progress = true;
+        {
+            auto lk = lock();
+            work.swap(m_shared_ready);
+            m_shared_size = 0u;
+        }
+        int const completed = work.size();
+        for (auto s : work)
+        {
+            auto ptr = s->release_self_ref();
+            s->invoke_cb();
+        }
+        work.clear();
+        in_progress = false;
+        return completed;
+    }
+
+    // drop the requests of a communicator which is going away
+    void remove(mailbox& mb)
+    {
+        auto lk = lock();
+        for (auto it = m_recvs.begin(); it != m_recvs.end();)
+        {
+            if (it->m_mailbox != &mb)
+            {
+                ++it;
+                continue;
+            }
+            auto ptr = it->m_state->release_self_ref();
+            it = m_recvs.erase(it);
+        }
+        for (auto it = m_messages.begin(); it != m_messages.end();)
+        {
+            if (it->m_mailbox != &mb)
+            {
+                ++it;
+                continue;
+            }
+            auto ptr = it->m_state->release_self_ref();
+            it = m_messages.erase(it);
+            --m_num_messages;
+        }
+        for (auto s : mb.m_ready) { auto ptr = s->release_self_ref(); }
+        mb.m_ready.clear();
+        mb.m_size = 0u;
+    }
+
+  private:
+    lock_type lock() { return m_thread_safe ? lock_type(m_mutex) : lock_type(); }
+
+    static bool matches(unsigned int r_range, tag_type r_tag, unsigned int range, tag_type tag)
+    {
+        return (r_range == range) && (r_tag == tag || r_tag < 0);
+    }
+
+    static void check_size(std::size_t size, std::size_t capacity)
+    {
+        if (size > capacity)
+            throw std::runtime_error("oomph: message to self truncated (" + std::to_string(size) +
+                                     " bytes into a receive of " + std::to_string(capacity) + ")");
+    }
+
+    void push(mailbox& mb, State* s)
+    {
+        mb.m_ready.push_back(s);
+        ++mb.m_size;
+    }
+
+    void push_shared(SharedState* s)
+    {
+        m_shared_ready.push_back(s);
+        ++m_shared_size;
+    }
+
+    bool match_message(unsigned int range, tag_type tag, void* ptr, std::size_t size)
+    {
+        auto it = std::find_if(m_messages.begin(), m_messages.end(),
+            [range, tag](auto const& m) { return matches(range, tag, m.m_range, m.m_tag); });
+        if (it == m_messages.end()) return false;
+        if (it->m_state)
+        {
+            // pending send: copy from the user's buffer and complete it
+            check_size(it->m_size, size);
+            std::memcpy(ptr, it->m_ptr, it->m_size);
+            push(*it->m_mailbox, it->m_state);
+        }
+        else
+        {
+            check_size(it->m_data.size(), size);
+            std::memcpy(ptr, it->m_data.data(), it->m_data.size());
+            m_free_buffers.push_back(std::move(it->m_data));
+        }
+        m_messages.erase(it);
+        --m_num_messages;
+        return true;
+    }
+
+    // buffers of matched messages are recycled
+    std::vector<char> make_buffer(void const* ptr, std::size_t size)
+    {
+        std::vector<char> buffer;
+        if (!m_free_buffers.empty())
+        {
+            buffer = std::move(m_free_buffers.back());
+            m_free_buffers.pop_back();
+        }
+        auto const p = static_cast<char const*>(ptr);
+        buffer.assign(p, p + size);
+        return buffer;
+    }
+};
+
+} // namespace oomph
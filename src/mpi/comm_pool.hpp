@@ -0,0 +1,166 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <oomph/util/mpi_error.hpp>
+
+namespace oomph
+{
+// ----------------------------------------
+// number of duplicated MPI communicators
+// ----------------------------------------
+static unsigned int
+mpi_comm_pool_size()
+{
+    auto env_str = std::getenv("OOMPH_MPI_COMM_POOL_SIZE");
+    if (env_str != nullptr)
+    {
+        char* end;
+        return std::strtoul(env_str, &end, 0);
+    }
+    return 0u;
+}
+
+// ----------------------------------------
+// matching hints promised by the user
+// ----------------------------------------
+static bool
+mpi_assert_hint(const char* env_name)
+{
+    auto env_str = std::getenv(env_name);
+    return (env_str != nullptr) && (std::string(env_str) != "0");
+}
+
+// ----------------------------------------
+// separate lane for priority::high
+// ----------------------------------------
+static bool
+mpi_priority_lane()
+{
+    auto env_str = std::getenv("OOMPH_MPI_PRIORITY_LANE");
+    return (env_str != nullptr) && (std::string(env_str) != "0");
+}
+
+// A fixed set of duplicates of the context's MPI communicator. Each oomph communicator posts its
+// point-to-point operations on one of them (selected by its tag range index), which gives every
+// thread its own matching queue inside the MPI library. The duplicates are created collectively
+// when the context is constructed, so communicators can still be created independently later on.
+// Another duplicate, without assertions, is created for the messages with priority::high if the
+// priority lane is enabled; otherwise they travel on the normal lane, as with the other backends.
+// The internal messages of the library (see internal_tag) are matched on a duplicate as well, which
+// is created by the first context and then kept as an attribute of the parent communicator: the
+// contexts on a communicator share it, so that internal messages which are still in flight when a
+// context is destroyed never reach a later duplicate which reuses the freed context id of the MPI
+// library (and would upset its message ordering).
+//
+// Opt-in through the environment:
+//   OOMPH_MPI_COMM_POOL_SIZE=<n>          number of duplicates (0: disabled, default)
+//   OOMPH_MPI_PRIORITY_LANE=1             separate lane for priority::high
+//   OOMPH_MPI_ASSERT_NO_ANY_SOURCE=1      no receive uses MPI_ANY_SOURCE
+//   OOMPH_MPI_ASSERT_NO_ANY_TAG=1         no receive uses MPI_ANY_TAG
+//   OOMPH_MPI_ASSERT_ALLOW_OVERTAKING=1   messages need not be matched in order
+// The assertions are only attached to the duplicates, and it is erroneous to break them.
+class comm_pool
+{
+  private:
+    MPI_Comm              m_parent;
+    MPI_Comm              m_internal;
+    MPI_Comm              m_priority = MPI_COMM_NULL;
+    std::vector<MPI_Comm> m_comms;
+    std::string           m_hints;
+    std::string           m_size_str;
+
+  public:
+    comm_pool(MPI_Comm parent)
+    : m_parent{parent}
+    , m_internal{internal_comm(parent)}
+    {
+        if (mpi_priority_lane())
+            OOMPH_CHECK_MPI_RESULT(MPI_Comm_dup(parent, &m_priority));
+        auto const n = mpi_comm_pool_size();
+        m_size_str = std::to_string(n);
+        if (n == 0u) return;
+
+        MPI_Info info;
+        OOMPH_CHECK_MPI_RESULT(MPI_Info_create(&info));
+        add_hint(info, "OOMPH_MPI_ASSERT_NO_ANY_SOURCE", "mpi_assert_no_any_source");
+        add_hint(info, "OOMPH_MPI_ASSERT_NO_ANY_TAG", "mpi_assert_no_any_tag");
+        add_hint(info, "OOMPH_MPI_ASSERT_ALLOW_OVERTAKING", "mpi_assert_allow_overtaking");
+        m_comms.resize(n, MPI_COMM_NULL);
+        for (auto& c : m_comms) OOMPH_CHECK_MPI_RESULT(MPI_Comm_dup_with_info(parent, info, &c));
+        MPI_Info_free(&info);
+    }
+
+    comm_pool(comm_pool const&) = delete;
+    comm_pool& operator=(comm_pool const&) = delete;
+
+    ~comm_pool()
+    {
+        for (auto& c : m_comms) MPI_Comm_free(&c);
+        if (m_priority != MPI_COMM_NULL) MPI_Comm_free(&m_priority);
+    }
+
+    unsigned int size() const noexcept { return m_comms.size(); }
+    const char*  size_string() const noexcept { return m_size_str.c_str(); }
+
+    // communicator used for the tag range with index i
+    MPI_Comm get(unsigned int i) const noexcept
+    {
+        return m_comms.empty() ? m_parent : m_comms[i % m_comms.size()];
+    }
+
+    // communicator of the priority lane (shared by all tag ranges), or MPI_COMM_NULL if disabled
+    MPI_Comm priority() const noexcept { return m_priority; }
+
+    // communicator of the internal lane (shared by all tag ranges, which keep their tags apart)
+    MPI_Comm internal() const noexcept { return m_internal; }
+
+    // comma separated list of the assertions in use
+    const char* hints() const noexcept { return m_hints.empty() ? "none" : m_hints.c_str(); }
+
+  private:
+    // the duplicate of the internal lane, freed together with the parent communicator
+    static MPI_Comm internal_comm(MPI_Comm parent)
+    {
+        static int keyval = MPI_KEYVAL_INVALID;
+        if (keyval == MPI_KEYVAL_INVALID)
+            OOMPH_CHECK_MPI_RESULT(MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN,
+                [](MPI_Comm, int, void* attr, void*)
+                {
+                    auto c = static_cast<MPI_Comm*>(attr);
+                    auto const result = MPI_Comm_free(c);
+                    delete c;
+                    return result;
+                },
+                &keyval, nullptr));
+        MPI_Comm* c;
+        int       flag;
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_get_attr(parent, keyval, &c, &flag));
+        if (flag) return *c;
+        c = new MPI_Comm;
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_dup(parent, c));
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_set_attr(parent, keyval, c));
+        return *c;
+    }
+
+    void add_hint(MPI_Info info, const char* env_name, const char* key)
+    {
+        if (!mpi_assert_hint(env_name)) return;
+        OOMPH_CHECK_MPI_RESULT(MPI_Info_set(info, key, "true"));
+        if (!m_hints.empty()) m_hints += ",";
+        m_hints += key;
+    }
+};
+
+} // namespace oomph
@@ -19,17 +19,37 @@
 
 namespace oomph
 {
+class remote_buffer_impl;
+
 class communicator_impl : public communicator_base<communicator_impl>
 {
+  public:
+    // messages with priority::high are matched on a communicator of their own, and their requests
+    // are progressed before all others
+    static constexpr bool has_priority_lane = true;
+    // receives of unknown size are matched with MPI_Improbe
+    static constexpr bool has_probe = true;
+
   public:
     context_impl* m_context;
     request_queue m_send_reqs;
     request_queue m_recv_reqs;
+    request_queue m_priority_send_reqs;
+    request_queue m_priority_recv_reqs;
+    MPI_Comm      m_matching_comm;
 
     communicator_impl(context_impl* ctxt)
     : communicator_base(ctxt)
     , m_context(ctxt)
+    , m_matching_comm(ctxt->matching_comm(0))
+    {
+    }
+
+    // the tag range also selects the (possibly duplicated) MPI communicator for matching
+    void set_tag_range(util::tag_range const& tr) noexcept
     {
+        communicator_base::set_tag_range(tr);
+        m_matching_comm = m_context->matching_comm(tr.index());
     }
 
     auto& get_heap() noexcept { return m_context->get_heap(); }
@@ -40,20 +60,22 @@ class communicator_impl : public communicator_base<communicator_impl>
     void end_group() {}
 
     mpi_request send(context_impl::heap_type::pointer const& ptr, std::size_t size, rank_type dst,
-        tag_type tag, [[maybe_unused]] void* stream)
+        tag_type tag, [[maybe_unused]] void* stream, MPI_Comm comm = MPI_COMM_NULL)
     {
         MPI_Request        r;
         const_device_guard dg(ptr);
-        OOMPH_CHECK_MPI_RESULT(MPI_Isend(dg.data(), size, MPI_BYTE, dst, tag, mpi_comm(), &r));
+        OOMPH_CHECK_MPI_RESULT(MPI_Isend(dg.data(), size, MPI_BYTE, dst, m_tag_range.map(tag),
+            comm == MPI_COMM_NULL ? m_matching_comm : comm, &r));
         return {r};
     }
 
     mpi_request recv(context_impl::heap_type::pointer& ptr, std::size_t size, rank_type src,
-        tag_type tag, [[maybe_unused]] void* stream)
+        tag_type tag, [[maybe_unused]] void* stream, MPI_Comm comm = MPI_COMM_NULL)
     {
         MPI_Request  r;
         device_guard dg(ptr);
-        OOMPH_CHECK_MPI_RESULT(MPI_Irecv(dg.data(), size, MPI_BYTE, src, tag, mpi_comm(), &r));
+        OOMPH_CHECK_MPI_RESULT(MPI_Irecv(dg.data(), size, MPI_BYTE, src, m_tag_range.map(tag),
+            comm == MPI_COMM_NULL ? m_matching_comm : comm, &r));
         return {r};
     }
 
@@ -61,48 +83,68 @@ class communicator_impl : public communicator_base<communicator_impl>
         tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
         std::size_t* scheduled, void* stream)
     {
-        auto req = send(ptr, size, dst, tag, stream);
-        if (!has_reached_recursion_depth() && req.is_ready())
-        {
-            auto inc = recursion();
-            cb(dst, tag);
-            return {};
-        }
-        else
-        {
-            auto s = m_req_state_factory.make(m_context, this, scheduled, dst, tag,
-                std::move(cb), req);
-            s->create_self_ref();
-            m_send_reqs.enqueue(s.get());
-            return {std::move(s)};
-        }
+        if (is_loopback(dst, ptr))
+            return send_loopback(ptr, size, dst, tag, std::move(cb), scheduled);
+        return track<send_request>(send(ptr, size, dst, tag, stream), m_send_reqs, dst, tag,
+            std::move(cb), scheduled);
     }
 
     recv_request recv(context_impl::heap_type::pointer& ptr, std::size_t size, rank_type src,
         tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
         std::size_t* scheduled, void* stream)
     {
-        auto req = recv(ptr, size, src, tag, stream);
-        if (!has_reached_recursion_depth() && req.is_ready())
-        {
-            auto inc = recursion();
-            cb(src, tag);
-            return {};
-        }
-        else
-        {
-            auto s = m_req_state_factory.make(m_context, this, scheduled, src, tag,
-                std::move(cb), req);
-            s->create_self_ref();
-            m_recv_reqs.enqueue(s.get());
-            return {std::move(s)};
-        }
+        if (is_loopback(src, ptr))
+            return recv_loopback(ptr, size, src, tag, std::move(cb), scheduled);
+        return track<recv_request>(recv(ptr, size, src, tag, stream), m_recv_reqs, src, tag,
+            std::move(cb), scheduled);
+    }
+
+    // the priority lane is opt-in (see comm_pool)
+    bool priority_lane_enabled() const noexcept
+    {
+        return m_context->priority_comm() != MPI_COMM_NULL;
+    }
+
+    // the priority and internal lanes bypass the loopback queue, which does not tell the lanes
+    // apart
+    send_request priority_send(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        rank_type dst, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
+        std::size_t* scheduled)
+    {
+        return track<send_request>(send(ptr, size, dst, tag, nullptr, m_context->priority_comm()),
+            m_priority_send_reqs, dst, tag, std::move(cb), scheduled);
+    }
+
+    recv_request priority_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
+        rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
+        std::size_t* scheduled)
+    {
+        return track<recv_request>(recv(ptr, size, src, tag, nullptr, m_context->priority_comm()),
+            m_priority_recv_reqs, src, tag, std::move(cb), scheduled);
+    }
+
+    send_request internal_send(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        rank_type dst, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
+        std::size_t* scheduled)
+    {
+        return track<send_request>(send(ptr, size, dst, tag, nullptr, m_context->internal_comm()),
+            m_send_reqs, dst, tag, std::move(cb), scheduled);
+    }
+
+    recv_request internal_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
+        rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
+        std::size_t* scheduled)
+    {
+        return track<recv_request>(recv(ptr, size, src, tag, nullptr, m_context->internal_comm()),
+            m_recv_reqs, src, tag, std::move(cb), scheduled);
     }
 
     shared_recv_request shared_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
         rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
         std::atomic<std::size_t>* scheduled, void* stream)
     {
+        if (is_loopback(src, ptr))
+            return shared_recv_loopback(ptr, size, src, tag, std::move(cb), scheduled);
         auto req = recv(ptr, size, src, tag, stream);
         if (!m_context->has_reached_recursion_depth() && req.is_ready())
         {
@@ -120,14 +162,130 @@ class communicator_impl : public communicator_base<communicator_impl>
         }
     }
 
+    // receives of unknown size, see any_size_queue: the matched probe takes the message out of
+    // the matching queue, so that it can only be received through the returned message handle
+    struct probe_result
+    {
+        MPI_Message m_message;
+        rank_type   m_src;
+        tag_type    m_tag;
+        std::size_t m_size;
+    };
+
+    // a probe with any_tag on a matching communicator which is shared by several tag ranges
+    // could take a message of another tag range out of the matching queue
+    void check_probe(tag_type tag) const
+    {
+        if (tag == communicator::any_tag &&
+            m_context->shares_matching_comm(m_tag_range.num_ranges()))
+            throw std::runtime_error("oomph: recv_any_size with any_tag needs a matching "
+                                     "communicator per tag range (OOMPH_MPI_COMM_POOL_SIZE)");
+    }
+
+    bool probe(rank_type src, tag_type tag, probe_result& r)
+    {
+        int        flag;
+        MPI_Status status;
+        OOMPH_CHECK_MPI_RESULT(MPI_Improbe(src, m_tag_range.map(tag), m_matching_comm, &flag,
+            &r.m_message, &status));
+        if (!flag) return false;
+        int count;
+        OOMPH_CHECK_MPI_RESULT(MPI_Get_count(&status, MPI_BYTE, &count));
+        r.m_src = status.MPI_SOURCE;
+        r.m_tag = status.MPI_TAG - m_tag_range.offset();
+        r.m_size = count;
+        return true;
+    }
+
+    recv_request recv_probed(probe_result& r, context_impl::heap_type::pointer& ptr,
+        util::unique_function<void(rank_type, tag_type)>&& cb, std::size_t* scheduled)
+    {
+        MPI_Request  req;
+        device_guard dg(ptr);
+        OOMPH_CHECK_MPI_RESULT(MPI_Imrecv(dg.data(), r.m_size, MPI_BYTE, &r.m_message, &req));
+        mpi_request mreq{req};
+        if (!has_reached_recursion_depth() && mreq.is_ready())
+        {
+            auto inc = recursion();
+            cb(r.m_src, r.m_tag);
+            return {};
+        }
+        auto s = m_req_state_factory.make(m_context, this, scheduled, r.m_src, r.m_tag,
+            std::move(cb), mreq);
+        s->create_self_ref();
+        m_recv_reqs.enqueue(s.get());
+        return {std::move(s)};
+    }
+
+    // request states of the operations matched by the loopback queue
+    auto make_loopback_state(std::size_t* scheduled, rank_type rank, tag_type tag, cb_type&& cb)
+    {
+        return m_req_state_factory.make(m_context, this, scheduled, rank, tag, std::move(cb),
+            mpi_request{MPI_REQUEST_NULL});
+    }
+
+    auto make_loopback_shared_state(std::atomic<std::size_t>* scheduled, rank_type rank,
+        tag_type tag, cb_type&& cb)
+    {
+        return std::make_shared<detail::shared_request_state>(m_context, this, scheduled, rank,
+            tag, std::move(cb), mpi_request{MPI_REQUEST_NULL});
+    }
+
+    // one-sided operations: defined in rma.hpp
+    rma_request put(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        remote_buffer_impl const& dst, std::size_t offset, std::size_t* scheduled);
+
+    rma_request get(context_impl::heap_type::pointer& ptr, std::size_t size,
+        remote_buffer_impl const& src, std::size_t offset, std::size_t* scheduled);
+
+    void flush(remote_buffer_impl const& dst);
+
+    // rma requests only complete locally and are tracked together with the sends
+    rma_request track_rma(mpi_request req, rank_type peer, std::size_t* scheduled)
+    {
+        if (req.is_ready()) return {};
+        auto s = m_req_state_factory.make(m_context, this, scheduled, peer, 0,
+            util::unique_function<void(rank_type, tag_type)>([](rank_type, tag_type) {}), req);
+        s->create_self_ref();
+        m_send_reqs.enqueue(s.get());
+        return {std::move(s)};
+    }
+
     void progress()
     {
+        m_priority_send_reqs.progress();
+        m_priority_recv_reqs.progress();
+        progress_loopback();
         m_send_reqs.progress();
         m_recv_reqs.progress();
         m_context->progress();
     }
 
-    bool cancel_recv(detail::request_state* s) { return m_recv_reqs.cancel(s); }
+    bool cancel_recv(detail::request_state* s)
+    {
+        if (s->m_loopback) return cancel_loopback(s);
+        if (m_priority_recv_reqs.contains(s)) return m_priority_recv_reqs.cancel(s);
+        return m_recv_reqs.cancel(s);
+    }
+
+  private:
+    // complete the operation right away if possible, otherwise queue its request state
+    template<typename Request>
+    Request track(mpi_request req, request_queue& q, rank_type peer, tag_type tag,
+        util::unique_function<void(rank_type, tag_type)>&& cb, std::size_t* scheduled)
+    {
+        if (!has_reached_recursion_depth() && req.is_ready())
+        {
+            auto inc = recursion();
+            cb(peer, tag);
+            return {};
+        }
+        auto s = m_req_state_factory.make(m_context, this, scheduled, peer, tag, std::move(cb),
+            req);
+        s->create_self_ref();
+        q.enqueue(s.get());
+        return {std::move(s)};
+    }
 };
 
 } // namespace oomph
@@ -26,6 +26,12 @@ const char *context_impl::get_transport_option(const std::string &opt) const {
     if (opt == "name") {
         return "mpi";
     }
+    else if (opt == "comm_pool") {
+        return m_comm_pool.size_string();
+    }
+    else if (opt == "comm_hints") {
+        return m_comm_pool.hints();
+    }
     else {
         return "unspecified";
     }
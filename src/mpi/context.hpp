@@ -16,6 +16,7 @@
 // paths relative to backend
 #include <../context_base.hpp>
 #include <rma_context.hpp>
+#include <comm_pool.hpp>
 #include <request_queue.hpp>
 
 namespace oomph
@@ -28,8 +29,9 @@ class context_impl : public context_base
     using heap_type = hwmalloc::heap<context_impl>;
 
   private:
-    heap_type m_heap;
-    //rma_context  m_rma_context;
+    heap_type    m_heap;
+    rma_context  m_rma_context;
+    comm_pool    m_comm_pool;
     unsigned int m_n_tag_bits;
 
   public:
@@ -39,7 +41,8 @@ class context_impl : public context_base
     context_impl(MPI_Comm comm, bool thread_safe, hwmalloc::heap_config const& heap_config)
     : context_base(comm, thread_safe)
     , m_heap{this, heap_config}
-    //, m_rma_context{m_mpi_comm}
+    , m_rma_context{m_mpi_comm}
+    , m_comm_pool{m_mpi_comm}
     {
         // get largest allowed tag value
         int  flag;
@@ -71,15 +74,43 @@ class context_impl : public context_base
 
     auto& get_heap() noexcept { return m_heap; }
 
-    //auto  get_window() const noexcept { return m_rma_context.get_window(); }
-    //auto& get_rma_heap() noexcept { return m_rma_context.get_heap(); }
-    //void  lock(rank_type r) { m_rma_context.lock(r); }
+    auto  get_window() const noexcept { return m_rma_context.get_window(); }
+    auto& get_rma_context() noexcept { return m_rma_context; }
+    void  lock(rank_type r) { m_rma_context.lock(r); }
+
+    // communicator on which point-to-point messages of the given tag range are matched
+    MPI_Comm matching_comm(unsigned int tag_range_index) const noexcept
+    {
+        return m_comm_pool.get(tag_range_index);
+    }
+
+    // whether some of num_ranges tag ranges are matched on the same communicator
+    bool shares_matching_comm(unsigned int num_ranges) const noexcept
+    {
+        return num_ranges > 1u && m_comm_pool.size() < num_ranges;
+    }
+
+    // communicator on which messages with priority::high are matched, or MPI_COMM_NULL if they
+    // travel on the normal lane
+    MPI_Comm priority_comm() const noexcept { return m_comm_pool.priority(); }
+
+    // communicator on which the internal messages of the library are matched
+    MPI_Comm internal_comm() const noexcept { return m_comm_pool.internal(); }
 
     communicator_impl* get_communicator();
 
-    void progress() { m_req_queue.progress(); }
+    void progress()
+    {
+        m_loopback.progress_any_source(m_any_source, rank());
+        m_loopback.progress_shared();
+        m_req_queue.progress();
+    }
 
-    bool cancel_recv(detail::shared_request_state* r) { return m_req_queue.cancel(r); }
+    bool cancel_recv(detail::shared_request_state* r)
+    {
+        if (r->m_loopback) return m_loopback.cancel(r) || m_any_source.cancel(r);
+        return m_req_queue.cancel(r);
+    }
 
     unsigned int num_tag_bits() const noexcept { return m_n_tag_bits; }
 
@@ -27,6 +27,9 @@ class request_queue
   private: // members
     queue_type               m_queue;
     queue_type               m_ready_queue;
+    // requests which completed while they were canceled
+    queue_type               m_completed;
+    queue_type               m_completed_work;
     bool                     in_progress = false;
     std::vector<MPI_Request> reqs;
     std::vector<int>         indices;
@@ -41,6 +44,11 @@ class request_queue
   public: // member functions
     std::size_t size() const noexcept { return m_queue.size(); }
 
+    bool contains(element_type const* e) const noexcept
+    {
+        return e->m_index < m_queue.size() && m_queue[e->m_index] == e;
+    }
+
     void enqueue(element_type* e)
     {
         e->m_index = m_queue.size();
@@ -52,11 +60,12 @@ class request_queue
         if (in_progress) return 0;
         in_progress = true;
 
+        int const late = progress_completed();
         const auto qs = size();
         if (qs == 0)
         {
             in_progress = false;
-            return 0;
+            return late;
         }
 
         m_ready_queue.clear();
@@ -74,10 +83,11 @@ class request_queue
         OOMPH_CHECK_MPI_RESULT(
             MPI_Testsome(qs, reqs.data(), &outcount, indices.data(), MPI_STATUSES_IGNORE));
 
-        if (outcount == 0)
+        // no active requests are reported as MPI_UNDEFINED
+        if (outcount == 0 || outcount == MPI_UNDEFINED)
         {
             in_progress = false;
-            return 0;
+            return late;
         }
 
         indices[outcount] = qs;
@@ -113,26 +123,44 @@ class request_queue
         }
 
         in_progress = false;
-        return completed;
+        return late + completed;
     }
 
     bool cancel(element_type* e)
     {
         auto const index = e->m_index;
-        if (m_queue[index]->m_req.cancel())
+        auto const canceled = m_queue[index]->m_req.cancel();
+        // otherwise the request has completed (and is no longer active): its callback is invoked
+        // by the next progress
+        if (canceled)
         {
             auto ptr = e->release_self_ref();
             e->set_canceled();
-            if (index + 1 < m_queue.size())
-            {
-                m_queue[index] = m_queue.back();
-                m_queue[index]->m_index = index;
-            }
-            m_queue.pop_back();
-            return true;
         }
         else
-            return false;
+            m_completed.push_back(e);
+        if (index + 1 < m_queue.size())
+        {
+            m_queue[index] = m_queue.back();
+            m_queue[index]->m_index = index;
+        }
+        m_queue.pop_back();
+        return canceled;
+    }
+
+  private:
+    int progress_completed()
+    {
+        if (m_completed.empty()) return 0;
+        m_completed_work.swap(m_completed);
+        int const completed = m_completed_work.size();
+        for (auto e : m_completed_work)
+        {
+            auto ptr = e->release_self_ref();
+            e->invoke_cb();
+        }
+        m_completed_work.clear();
+        return completed;
     }
 };
 
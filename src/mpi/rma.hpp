@@ -0,0 +1,87 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <oomph/rma.hpp>
+
+// paths relative to backend
+#include <communicator.hpp>
+
+namespace oomph
+{
+// Memory is attached to the dynamic window of the context. The descriptor carries the absolute
+// address of the memory, which is the target displacement for dynamic windows.
+class exposed_buffer_impl
+{
+  private:
+    rma_region     m_region;
+    rma_descriptor m_descriptor;
+
+  public:
+    exposed_buffer_impl(communicator_impl* comm, context_impl::heap_type::pointer& ptr,
+        std::size_t size)
+    : m_region{comm->m_context->get_rma_context().make_region(device_guard(ptr).data(), size)}
+    {
+        auto const h = m_region.get_handle(0, size);
+        m_descriptor.m_rank = comm->rank();
+        m_descriptor.m_address = h.get_remote_key();
+        m_descriptor.m_size = size;
+        m_descriptor.m_key_size = 0u;
+    }
+
+    rma_descriptor const& descriptor() const noexcept { return m_descriptor; }
+};
+
+// Passive target access: the window is locked (shared) once per target rank through the lock
+// cache of the context and stays locked until the context is destroyed.
+class remote_buffer_impl
+{
+  public:
+    rank_type m_rank;
+    MPI_Aint  m_address;
+
+  public:
+    remote_buffer_impl(communicator_impl* comm, rma_descriptor const& d)
+    : m_rank{d.m_rank}
+    , m_address{(MPI_Aint)d.m_address}
+    {
+        comm->m_context->lock(m_rank);
+    }
+};
+
+inline rma_request
+communicator_impl::put(context_impl::heap_type::pointer const& ptr, std::size_t size,
+    remote_buffer_impl const& dst, std::size_t offset, std::size_t* scheduled)
+{
+    MPI_Request        r;
+    const_device_guard dg(ptr);
+    OOMPH_CHECK_MPI_RESULT(MPI_Rput(dg.data(), size, MPI_BYTE, dst.m_rank,
+        MPI_Aint_add(dst.m_address, offset), size, MPI_BYTE, m_context->get_window(), &r));
+    return track_rma(mpi_request{r}, dst.m_rank, scheduled);
+}
+
+inline rma_request
+communicator_impl::get(context_impl::heap_type::pointer& ptr, std::size_t size,
+    remote_buffer_impl const& src, std::size_t offset, std::size_t* scheduled)
+{
+    MPI_Request  r;
+    device_guard dg(ptr);
+    OOMPH_CHECK_MPI_RESULT(MPI_Rget(dg.data(), size, MPI_BYTE, src.m_rank,
+        MPI_Aint_add(src.m_address, offset), size, MPI_BYTE, m_context->get_window(), &r));
+    return track_rma(mpi_request{r}, src.m_rank, scheduled);
+}
+
+inline void
+communicator_impl::flush(remote_buffer_impl const& dst)
+{
+    OOMPH_CHECK_MPI_RESULT(MPI_Win_flush(dst.m_rank, m_context->get_window()));
+}
+
+} // namespace oomph
@@ -9,6 +9,10 @@
  */
 #pragma once
 
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
 #include <hwmalloc/register.hpp>
 #include <hwmalloc/heap.hpp>
 #include <oomph/config.hpp>
@@ -19,6 +23,16 @@
 
 namespace oomph
 {
+// ----------------------------------------
+// one-sided communication
+// ----------------------------------------
+static bool
+mpi_rma_enabled()
+{
+    auto env_str = std::getenv("OOMPH_MPI_RMA");
+    return (env_str != nullptr) && (std::string(env_str) != "0");
+}
+
 class rma_context
 {
   public:
@@ -29,26 +43,55 @@ class rma_context
   private:
     struct mpi_win_holder
     {
-        MPI_Win m;
-        ~mpi_win_holder() { MPI_Win_free(&m); }
+        MPI_Win m = MPI_WIN_NULL;
+        ~mpi_win_holder()
+        {
+            if (m != MPI_WIN_NULL) MPI_Win_free(&m);
+        }
     };
 
   private:
     MPI_Comm                    m_mpi_comm;
+    bool const                  m_enabled;
     mpi_win_holder              m_win;
     heap_type                   m_heap;
     std::unique_ptr<lock_cache> m_lock_cache;
 
   public:
+    // The dynamic window is only created (collectively, with the context) if enabled through the
+    // environment with OOMPH_MPI_RMA=1 (identically on all ranks), so that contexts which do not
+    // use RMA do not pay for it. Some MPI implementations cannot create a dynamic window on every
+    // communicator (Open MPI 4.1 fails on a single rank): the ranks agree on whether it succeeded
+    // everywhere before the window is fenced, and otherwise do without it. Contexts without a
+    // window still work, and report the error when memory is exposed or a remote buffer is
+    // accessed.
     rma_context(MPI_Comm comm)
     : m_mpi_comm{comm}
+    , m_enabled{mpi_rma_enabled()}
     , m_heap{this}
     {
+        if (!m_enabled) return;
         MPI_Info info;
         OOMPH_CHECK_MPI_RESULT(MPI_Info_create(&info));
         OOMPH_CHECK_MPI_RESULT(MPI_Info_set(info, "no_locks", "false"));
-        OOMPH_CHECK_MPI_RESULT(MPI_Win_create_dynamic(info, m_mpi_comm, &(m_win.m)));
+        MPI_Errhandler errhandler;
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_get_errhandler(m_mpi_comm, &errhandler));
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_set_errhandler(m_mpi_comm, MPI_ERRORS_RETURN));
+        int const result = MPI_Win_create_dynamic(info, m_mpi_comm, &(m_win.m));
+        OOMPH_CHECK_MPI_RESULT(MPI_Comm_set_errhandler(m_mpi_comm, errhandler));
+        MPI_Errhandler_free(&errhandler);
         MPI_Info_free(&info);
+        if (result != MPI_SUCCESS) m_win.m = MPI_WIN_NULL;
+        int created = (result == MPI_SUCCESS) ? 1 : 0;
+        OOMPH_CHECK_MPI_RESULT(
+            MPI_Allreduce(MPI_IN_PLACE, &created, 1, MPI_INT, MPI_MIN, m_mpi_comm));
+        // a window which exists on some of the ranks only cannot be freed (collectively): it is
+        // dropped
+        if (!created)
+        {
+            m_win.m = MPI_WIN_NULL;
+            return;
+        }
         OOMPH_CHECK_MPI_RESULT(MPI_Win_fence(0, m_win.m));
         m_lock_cache = std::make_unique<lock_cache>(m_win.m);
     }
@@ -57,12 +100,27 @@ class rma_context
 
     rma_region make_region(void* ptr, std::size_t size) const
     {
+        check_window();
         return {m_mpi_comm, m_win.m, ptr, size};
     }
 
     auto  get_window() const noexcept { return m_win.m; }
     auto& get_heap() noexcept { return m_heap; }
-    void  lock(rank_type r) { m_lock_cache->lock(r); }
+    void  lock(rank_type r)
+    {
+        check_window();
+        m_lock_cache->lock(r);
+    }
+
+  private:
+    void check_window() const
+    {
+        if (m_win.m == MPI_WIN_NULL)
+            throw std::runtime_error(m_enabled
+                                         ? "oomph: RMA is not available, MPI_Win_create_dynamic "
+                                           "failed"
+                                         : "oomph: RMA is not enabled, set OOMPH_MPI_RMA=1");
+    }
 };
 
 template<>
@@ -9,7 +9,9 @@
  */
 #pragma once
 
+#include <cassert>
 #include <chrono>
+#include <deque>
 #include <optional>
 #include <stdexcept>
 #include <thread>
@@ -30,8 +32,14 @@
 
 namespace oomph
 {
+class remote_buffer_impl;
+
 class communicator_impl : public communicator_base<communicator_impl>
 {
+  public:
+    // credits are returned through receives from any source
+    static constexpr bool has_flow_control = false;
+
   public:
     context_impl* m_context;
     request_queue m_send_reqs;
@@ -69,6 +77,21 @@ class communicator_impl : public communicator_base<communicator_impl>
 
     bool is_group_active() const noexcept { return m_group_info.has_value(); }
 
+    // A send to self outside of a group is not handed to NCCL, which would block on the
+    // matching receive. It is kept until the next receive from self (NCCL matches in order
+    // anyway) and then copied with cudaMemcpyAsync on the stream of the receive, after the
+    // stream of the send has reached the point where the send was posted. The send completes
+    // with the copy.
+    struct self_send
+    {
+        void const*               m_ptr;
+        std::size_t               m_size;
+        detail::cached_cuda_event m_ready;
+        detail::group_cuda_event  m_done;
+    };
+
+    std::deque<self_send> m_self_sends;
+
   public:
     communicator_impl(context_impl* ctxt)
     : communicator_base(ctxt)
@@ -116,9 +139,11 @@ class communicator_impl : public communicator_base<communicator_impl>
     {
         if (dst == m_context->rank() && !is_group_active())
         {
-            throw std::runtime_error(
-                "oomph NCCL backend: self-send/recv requires an active NCCL group. "
-                "Use start_group()/end_group() around self-send/recv operations.");
+            const_device_guard dg(ptr);
+            m_self_sends.push_back(self_send{dg.data(), size, {}, {}});
+            m_self_sends.back().m_ready.record(static_cast<cudaStream_t>(stream));
+            // the event is recorded by the matching receive
+            return {m_self_sends.back().m_done};
         }
         const_device_guard dg(ptr);
         OOMPH_CHECK_NCCL_RESULT(ncclSend(dg.data(), size, ncclChar, dst, m_context->get_comm(),
@@ -144,9 +169,24 @@ class communicator_impl : public communicator_base<communicator_impl>
     {
         if (src == m_context->rank() && !is_group_active())
         {
-            throw std::runtime_error(
-                "oomph NCCL backend: self-send/recv requires an active NCCL group. "
-                "Use start_group()/end_group() around self-send/recv operations.");
+            if (m_self_sends.empty())
+            {
+                throw std::runtime_error(
+                    "oomph NCCL backend: self-recv outside of a NCCL group requires a preceding "
+                    "self-send. Use start_group()/end_group() around self-send/recv operations.");
+            }
+            device_guard dg(ptr);
+            auto         s = std::move(m_self_sends.front());
+            m_self_sends.pop_front();
+            assert(s.m_size <= size && "message truncated");
+            auto const strm = static_cast<cudaStream_t>(stream);
+            OOMPH_CHECK_CUDA_RESULT(cudaStreamWaitEvent(strm, s.m_ready.get(), 0));
+            OOMPH_CHECK_CUDA_RESULT(
+                cudaMemcpyAsync(dg.data(), s.m_ptr, s.m_size, cudaMemcpyDefault, strm));
+            s.m_done.record(strm);
+            detail::cached_cuda_event event;
+            event.record(strm);
+            return {std::move(event)};
         }
         device_guard dg(ptr);
         OOMPH_CHECK_NCCL_RESULT(ncclRecv(dg.data(), size, ncclChar, src, m_context->get_comm(),
@@ -191,6 +231,21 @@ class communicator_impl : public communicator_base<communicator_impl>
         return {std::move(s)};
     }
 
+    // all destinations are submitted in one NCCL group (unless the user already opened one)
+    void send_multi(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        rank_type const* neighs, tag_type const* tags, tag_type tag,
+        detail::multi_request_state* mrs, std::size_t* scheduled, void* stream)
+    {
+        if (is_group_active())
+        {
+            communicator_base::send_multi(ptr, size, neighs, tags, tag, mrs, scheduled, stream);
+            return;
+        }
+        start_group();
+        communicator_base::send_multi(ptr, size, neighs, tags, tag, mrs, scheduled, stream);
+        end_group();
+    }
+
     shared_recv_request shared_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
         rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
         std::atomic<std::size_t>* scheduled, void* stream)
@@ -203,6 +258,47 @@ class communicator_impl : public communicator_base<communicator_impl>
         return {std::move(s)};
     }
 
+    // the internal messages of the library are only sent by active messages and the flow
+    // control, neither of which is available with NCCL
+    send_request internal_send(context_impl::heap_type::pointer const&, std::size_t, rank_type,
+        tag_type, util::unique_function<void(rank_type, tag_type)>&&, std::size_t*)
+    {
+        throw std::runtime_error("oomph NCCL backend: internal messages are not supported");
+    }
+
+    recv_request internal_recv(context_impl::heap_type::pointer&, std::size_t, rank_type, tag_type,
+        util::unique_function<void(rank_type, tag_type)>&&, std::size_t*)
+    {
+        throw std::runtime_error("oomph NCCL backend: internal messages are not supported");
+    }
+
+    void register_am(am_id, am_handler&&)
+    {
+        throw std::runtime_error("oomph NCCL backend: active messages are not supported");
+    }
+
+    template<typename Pointer>
+    send_request send_am(rank_type, am_id, void const*, std::size_t, Pointer const*, std::size_t,
+        std::size_t*)
+    {
+        throw std::runtime_error("oomph NCCL backend: active messages are not supported");
+    }
+
+    template<typename CallBack>
+    recv_request recv_any_size(rank_type, tag_type, CallBack&&, std::size_t*)
+    {
+        throw std::runtime_error("oomph NCCL backend: recv_any_size is not supported");
+    }
+
+    // one-sided operations: defined in rma.hpp
+    rma_request put(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        remote_buffer_impl const& dst, std::size_t offset, std::size_t* scheduled);
+
+    rma_request get(context_impl::heap_type::pointer& ptr, std::size_t size,
+        remote_buffer_impl const& src, std::size_t offset, std::size_t* scheduled);
+
+    void flush(remote_buffer_impl const& dst);
+
     void progress()
     {
         if (is_group_active())
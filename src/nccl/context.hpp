@@ -67,6 +67,9 @@ class context_impl : public context_base
 
     bool cancel_recv(detail::shared_request_state*) { return false; }
 
+    // tags are not used for matching by nccl
+    unsigned int num_tag_bits() const noexcept { return 31; }
+
     const char* get_transport_option(const std::string& opt) const;
 };
 
@@ -0,0 +1,65 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <stdexcept>
+
+#include <oomph/rma.hpp>
+
+// paths relative to backend
+#include <communicator.hpp>
+
+namespace oomph
+{
+// one-sided communication is not implemented for the nccl backend
+class exposed_buffer_impl
+{
+  private:
+    rma_descriptor m_descriptor;
+
+  public:
+    exposed_buffer_impl(communicator_impl*, context_impl::heap_type::pointer&, std::size_t)
+    {
+        throw std::runtime_error("oomph: rma is not supported by the nccl backend");
+    }
+
+    rma_descriptor const& descriptor() const noexcept { return m_descriptor; }
+};
+
+class remote_buffer_impl
+{
+  public:
+    remote_buffer_impl(communicator_impl*, rma_descriptor const&)
+    {
+        throw std::runtime_error("oomph: rma is not supported by the nccl backend");
+    }
+};
+
+inline rma_request
+communicator_impl::put(context_impl::heap_type::pointer const&, std::size_t,
+    remote_buffer_impl const&, std::size_t, std::size_t*)
+{
+    throw std::runtime_error("oomph: rma is not supported by the nccl backend");
+}
+
+inline rma_request
+communicator_impl::get(context_impl::heap_type::pointer&, std::size_t, remote_buffer_impl const&,
+    std::size_t, std::size_t*)
+{
+    throw std::runtime_error("oomph: rma is not supported by the nccl backend");
+}
+
+inline void
+communicator_impl::flush(remote_buffer_impl const&)
+{
+    throw std::runtime_error("oomph: rma is not supported by the nccl backend");
+}
+
+} // namespace oomph
@@ -118,14 +118,36 @@ shared_recv_request::cancel()
 }
 
 bool
-send_multi_request::is_ready() const noexcept
+rma_request::is_ready() const noexcept
+{
+    if (!m) return true;
+    return m->is_ready();
+}
+
+bool
+rma_request::test()
+{
+    if (!m || m->is_ready()) return true;
+    m->progress();
+    return m->is_ready();
+}
+
+void
+rma_request::wait()
+{
+    if (!m) return;
+    while (!m->is_ready()) m->progress();
+}
+
+bool
+detail::multi_request::is_ready() const noexcept
 {
     if (!m) return true;
     return (m->m_counter == 0);
 }
 
 bool
-send_multi_request::test()
+detail::multi_request::test()
 {
     if (!m) return true;
     if (m->m_counter == 0) return true;
@@ -134,7 +156,7 @@ send_multi_request::test()
 }
 
 void
-send_multi_request::wait()
+detail::multi_request::wait()
 {
     if (!m) return;
     if (m->m_counter == 0) return;
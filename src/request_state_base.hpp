@@ -73,6 +73,7 @@ struct request_state_base
     cb_type            m_cb;
     type<bool>         m_ready;
     type<bool>         m_canceled;
+    bool               m_loopback = false; // matched by the loopback queue, not by the transport
 
     request_state_base(context_type* ctxt, communicator_type* comm, type<std::size_t>* scheduled,
         rank_type rank, tag_type tag, cb_type&& cb)
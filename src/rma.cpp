@@ -0,0 +1,107 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <memory>
+#include <oomph/config.hpp>
+#include <oomph/rma.hpp>
+
+// paths relative to backend
+#include <communicator.hpp>
+#include <rma.hpp>
+#include <../message_buffer.hpp>
+#include <../util/heap_pimpl_src.hpp>
+
+OOMPH_INSTANTIATE_HEAP_PIMPL(oomph::exposed_buffer_impl)
+OOMPH_INSTANTIATE_HEAP_PIMPL(oomph::remote_buffer_impl)
+
+namespace oomph
+{
+
+exposed_buffer::exposed_buffer() = default;
+
+exposed_buffer::exposed_buffer(exposed_buffer_impl* impl, rma_descriptor const& d)
+: m_impl{impl}
+, m_descriptor{d}
+{
+}
+
+exposed_buffer::exposed_buffer(exposed_buffer&&) noexcept = default;
+
+exposed_buffer& exposed_buffer::operator=(exposed_buffer&&) noexcept = default;
+
+exposed_buffer::~exposed_buffer() = default;
+
+remote_buffer::remote_buffer() = default;
+
+remote_buffer::remote_buffer(remote_buffer_impl* impl, rank_type rank, std::size_t size)
+: m_impl{impl}
+, m_rank{rank}
+, m_size{size}
+{
+}
+
+remote_buffer::remote_buffer(remote_buffer&&) noexcept = default;
+
+remote_buffer& remote_buffer::operator=(remote_buffer&&) noexcept = default;
+
+remote_buffer::~remote_buffer() = default;
+
+exposed_buffer
+communicator::expose(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size)
+{
+    auto impl = std::make_unique<exposed_buffer_impl>(m_state->m_impl, m_ptr->m, size);
+    auto d = impl->descriptor();
+    return {impl.release(), d};
+}
+
+remote_buffer
+communicator::attach(rma_descriptor const& d)
+{
+    auto impl = std::make_unique<remote_buffer_impl>(m_state->m_impl, d);
+    return {impl.release(), d.m_rank, d.m_size};
+}
+
+remote_buffer
+communicator::exchange(exposed_buffer const& local, rank_type peer, tag_type tag)
+{
+    auto s_msg = make_buffer<rma_descriptor>(1);
+    auto r_msg = make_buffer<rma_descriptor>(1);
+    s_msg[0] = local.descriptor();
+    auto r_req = recv(r_msg, peer, tag);
+    auto s_req = send(s_msg, peer, tag);
+    while (!(r_req.test() && s_req.test())) {}
+    return attach(r_msg[0]);
+}
+
+rma_request
+communicator::put(detail::message_buffer::heap_ptr_impl const* m_ptr, std::size_t size,
+    remote_buffer const& dst, std::size_t offset)
+{
+    assert(dst);
+    return m_state->m_impl->put(m_ptr->m, size, *dst.m_impl, offset,
+        &(m_state->scheduled_sends));
+}
+
+rma_request
+communicator::get(detail::message_buffer::heap_ptr_impl* m_ptr, std::size_t size,
+    remote_buffer const& src, std::size_t offset)
+{
+    assert(src);
+    return m_state->m_impl->get(m_ptr->m, size, *src.m_impl, offset,
+        &(m_state->scheduled_sends));
+}
+
+void
+communicator::flush(remote_buffer const& dst)
+{
+    assert(dst);
+    m_state->m_impl->flush(*dst.m_impl);
+}
+
+} // namespace oomph
@@ -0,0 +1,78 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace oomph
+{
+// ----------------------------------------
+// option from the environment or a profile
+// ----------------------------------------
+// The profile named by OOMPH_PROFILE (as written by bench_autotune) holds lines NAME=value, and
+// lines starting with # are comments. A variable which is set in the environment takes precedence
+// over the profile. Returns an empty string if the option is set in neither.
+static std::string
+profile_getenv(const char* name)
+{
+    if (auto env_str = std::getenv(name)) return env_str;
+    auto file_name = std::getenv("OOMPH_PROFILE");
+    if (file_name == nullptr) return {};
+    std::ifstream     file(file_name);
+    std::string const key = std::string(name) + "=";
+    std::string       line;
+    while (std::getline(file, line))
+        if (line.compare(0, key.size(), key) == 0) return line.substr(key.size());
+    return {};
+}
+
+static std::size_t
+profile_getenv(const char* name, std::size_t def_val)
+{
+    auto const str = profile_getenv(name);
+    if (str.empty()) return def_val;
+    char* end;
+    return std::strtoull(str.c_str(), &end, 0);
+}
+
+// Protocol thresholds of the transport in bytes, read when the context is created. Zero leaves the
+// choice to the transport. Backends apply what their transport allows them to change, see the
+// README.
+//
+// Configured through the environment or the profile (see profile_getenv):
+//   OOMPH_RNDV_THRESHOLD=<n>       messages of at least n bytes use the rendezvous protocol
+//   OOMPH_INJECT_THRESHOLD=<n>     messages of at most n bytes are injected
+class thresholds
+{
+  private:
+    std::size_t const m_rndv;
+    std::size_t const m_inject;
+    std::string const m_rndv_str;
+    std::string const m_inject_str;
+
+  public:
+    thresholds()
+    : m_rndv{profile_getenv("OOMPH_RNDV_THRESHOLD", 0u)}
+    , m_inject{profile_getenv("OOMPH_INJECT_THRESHOLD", 0u)}
+    , m_rndv_str{m_rndv ? std::to_string(m_rndv) : "default"}
+    , m_inject_str{m_inject ? std::to_string(m_inject) : "default"}
+    {
+    }
+
+  public:
+    std::size_t rndv() const noexcept { return m_rndv; }
+    std::size_t inject() const noexcept { return m_inject; }
+    const char* rndv_string() const noexcept { return m_rndv_str.c_str(); }
+    const char* inject_string() const noexcept { return m_inject_str.c_str(); }
+};
+
+} // namespace oomph
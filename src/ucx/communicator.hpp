@@ -9,6 +9,8 @@
  */
 #pragma once
 
+#include <utility>
+
 #include <boost/lockfree/queue.hpp>
 
 #include <oomph/context.hpp>
@@ -21,9 +23,14 @@
 
 namespace oomph
 {
+class remote_buffer_impl;
 
 class communicator_impl : public communicator_base<communicator_impl>
 {
+  public:
+    // receives of unknown size are matched with ucp_tag_probe_nb
+    static constexpr bool has_probe = true;
+
   public:
     using worker_type = worker_t;
     template<typename T>
@@ -77,6 +84,7 @@ class communicator_impl : public communicator_base<communicator_impl>
 
     void progress()
     {
+        progress_loopback();
         while (ucp_worker_progress(m_send_worker->get())) {}
         if (m_thread_safe)
         {
@@ -127,13 +135,17 @@ class communicator_impl : public communicator_base<communicator_impl>
             });
     }
 
+    // internal messages of the library are sent with OOMPH_UCX_INTERNAL_TAG, which keeps them
+    // apart from the user messages, and bypass the loopback queue
     send_request send(context_impl::heap_type::pointer const& ptr, std::size_t size, rank_type dst,
         tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
-        std::size_t* scheduled, [[maybe_unused]] void* stream)
+        std::size_t* scheduled, [[maybe_unused]] void* stream, bool internal = false)
     {
+        if (!internal && is_loopback(dst, ptr))
+            return send_loopback(ptr, size, dst, tag, std::move(cb), scheduled);
         const auto& ep = m_send_worker->connect(dst);
-        const auto  stag =
-            ((std::uint_fast64_t)tag << OOMPH_UCX_TAG_BITS) | (std::uint_fast64_t)(rank());
+        const auto  stag = ((std::uint_fast64_t)m_tag_range.map(tag) << OOMPH_UCX_TAG_BITS) |
+                          (std::uint_fast64_t)(rank()) | (internal ? OOMPH_UCX_INTERNAL_TAG : 0u);
 
         ucs_status_ptr_t ret;
         {
@@ -189,18 +201,30 @@ class communicator_impl : public communicator_base<communicator_impl>
         }
     }
 
+    // wire tag and tag mask of a receive from src (or any_source) with tag (or any_tag): any_tag
+    // matches all tags of the tag range of this communicator, and never the internal messages
+    std::pair<std::uint_fast64_t, std::uint_fast64_t> recv_tag(rank_type src, tag_type tag,
+        bool internal = false) const noexcept
+    {
+        auto wtag = (std::uint_fast64_t)m_tag_range.map(tag);
+        auto tag_mask = OOMPH_UCX_TAG_MASK;
+        if (communicator::any_tag == tag)
+        {
+            wtag = (std::uint_fast64_t)m_tag_range.offset();
+            tag_mask &= ~((std::uint_fast64_t)m_tag_range.max_tag() << OOMPH_UCX_TAG_BITS);
+        }
+        wtag = (wtag << OOMPH_UCX_TAG_BITS) | (internal ? OOMPH_UCX_INTERNAL_TAG : 0u);
+        if (communicator::any_source == src) return {wtag, tag_mask | OOMPH_UCX_ANY_SOURCE_MASK};
+        return {wtag | (std::uint_fast64_t)(src), tag_mask | OOMPH_UCX_SPECIFIC_SOURCE_MASK};
+    }
+
     recv_request recv(context_impl::heap_type::pointer& ptr, std::size_t size, rank_type src,
         tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
-        std::size_t* scheduled, [[maybe_unused]] void* stream)
+        std::size_t* scheduled, [[maybe_unused]] void* stream, bool internal = false)
     {
-        const auto rtag =
-            (communicator::any_source == src)
-                ? ((std::uint_fast64_t)tag << OOMPH_UCX_TAG_BITS)
-                : ((std::uint_fast64_t)tag << OOMPH_UCX_TAG_BITS) | (std::uint_fast64_t)(src);
-
-        const auto rtag_mask = (communicator::any_source == src)
-                                   ? (OOMPH_UCX_TAG_MASK | OOMPH_UCX_ANY_SOURCE_MASK)
-                                   : (OOMPH_UCX_TAG_MASK | OOMPH_UCX_SPECIFIC_SOURCE_MASK);
+        if (!internal && is_loopback(src, ptr))
+            return recv_loopback(ptr, size, src, tag, std::move(cb), scheduled);
+        const auto [rtag, rtag_mask] = recv_tag(src, tag, internal);
 
         if (m_thread_safe) m_mutex.lock();
         ucs_status_ptr_t ret;
@@ -261,18 +285,101 @@ class communicator_impl : public communicator_base<communicator_impl>
         }
     }
 
+    send_request internal_send(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        rank_type dst, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
+        std::size_t* scheduled)
+    {
+        return send(ptr, size, dst, tag, std::move(cb), scheduled, nullptr, true);
+    }
+
+    recv_request internal_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
+        rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
+        std::size_t* scheduled)
+    {
+        return recv(ptr, size, src, tag, std::move(cb), scheduled, nullptr, true);
+    }
+
+    // receives of unknown size, see any_size_queue: the probe removes the message from the
+    // unexpected queue of the worker, and it is received through the returned message handle
+    struct probe_result
+    {
+        ucp_tag_message_h m_message;
+        rank_type         m_src;
+        tag_type          m_tag;
+        std::size_t       m_size;
+    };
+
+    // probes with any_tag are confined to the tag range by recv_tag
+    void check_probe(tag_type) const noexcept {}
+
+    bool probe(rank_type src, tag_type tag, probe_result& r)
+    {
+        const auto [rtag, rtag_mask] = recv_tag(src, tag);
+
+        ucp_tag_recv_info_t info;
+        if (m_thread_safe) m_mutex.lock();
+        r.m_message = ucp_tag_probe_nb(m_recv_worker->get(), rtag, rtag_mask, 1, &info);
+        if (m_thread_safe) m_mutex.unlock();
+        if (r.m_message == nullptr) return false;
+        r.m_src = (rank_type)(info.sender_tag & OOMPH_UCX_SPECIFIC_SOURCE_MASK);
+        r.m_tag = (tag_type)(info.sender_tag >> OOMPH_UCX_TAG_BITS) - m_tag_range.offset();
+        r.m_size = info.length;
+        return true;
+    }
+
+    recv_request recv_probed(probe_result& r, context_impl::heap_type::pointer& ptr,
+        util::unique_function<void(rank_type, tag_type)>&& cb, std::size_t* scheduled)
+    {
+        if (m_thread_safe) m_mutex.lock();
+        ucs_status_ptr_t ret;
+        {
+            device_guard dg(ptr);
+
+            ret = ucp_tag_msg_recv_nb(m_recv_worker->get(), // worker
+                dg.data(),                                  // buffer
+                r.m_size,                                   // buffer size
+                ucp_dt_make_contig(1),                      // data type
+                r.m_message,                                // probed message
+                &communicator_impl::recv_callback);         // callback function pointer
+        }
+
+        if (UCS_PTR_IS_ERR(ret))
+        {
+            if (m_thread_safe) m_mutex.unlock();
+            throw std::runtime_error("oomph: ucx error - recv operation failed");
+        }
+        if (UCS_INPROGRESS != ucp_request_check_status(ret))
+        {
+            // early completed
+            ucp_request_free(ret);
+            if (m_thread_safe) m_mutex.unlock();
+            if (!has_reached_recursion_depth())
+            {
+                auto inc = recursion();
+                cb(r.m_src, r.m_tag);
+                return {};
+            }
+            auto s = m_req_state_factory.make(m_context, this, scheduled, r.m_src, r.m_tag,
+                std::move(cb), ret, m_mutex);
+            s->create_self_ref();
+            enqueue_recv(s.get());
+            return {std::move(s)};
+        }
+        auto s = m_req_state_factory.make(m_context, this, scheduled, r.m_src, r.m_tag,
+            std::move(cb), ret, m_mutex);
+        s->create_self_ref();
+        request_data::construct(ret, s.get());
+        if (m_thread_safe) m_mutex.unlock();
+        return {std::move(s)};
+    }
+
     shared_recv_request shared_recv(context_impl::heap_type::pointer& ptr, std::size_t size,
         rank_type src, tag_type tag, util::unique_function<void(rank_type, tag_type)>&& cb,
         std::atomic<std::size_t>* scheduled, [[maybe_unused]] void* stream)
     {
-        const auto rtag =
-            (communicator::any_source == src)
-                ? ((std::uint_fast64_t)tag << OOMPH_UCX_TAG_BITS)
-                : ((std::uint_fast64_t)tag << OOMPH_UCX_TAG_BITS) | (std::uint_fast64_t)(src);
-
-        const auto rtag_mask = (communicator::any_source == src)
-                                   ? (OOMPH_UCX_TAG_MASK | OOMPH_UCX_ANY_SOURCE_MASK)
-                                   : (OOMPH_UCX_TAG_MASK | OOMPH_UCX_SPECIFIC_SOURCE_MASK);
+        if (is_loopback(src, ptr))
+            return shared_recv_loopback(ptr, size, src, tag, std::move(cb), scheduled);
+        const auto [rtag, rtag_mask] = recv_tag(src, tag);
 
         if (m_thread_safe) m_mutex.lock();
         ucs_status_ptr_t ret;
@@ -332,6 +439,55 @@ class communicator_impl : public communicator_base<communicator_impl>
         }
     }
 
+    // request states of the operations matched by the loopback queue
+    auto make_loopback_state(std::size_t* scheduled, rank_type rank, tag_type tag, cb_type&& cb)
+    {
+        return m_req_state_factory.make(m_context, this, scheduled, rank, tag, std::move(cb),
+            nullptr, m_mutex);
+    }
+
+    auto make_loopback_shared_state(std::atomic<std::size_t>* scheduled, rank_type rank,
+        tag_type tag, cb_type&& cb)
+    {
+        return std::make_shared<detail::shared_request_state>(m_context, this, scheduled, rank,
+            tag, std::move(cb), nullptr, m_mutex);
+    }
+
+    // one-sided operations: defined in rma.hpp
+    rma_request put(context_impl::heap_type::pointer const& ptr, std::size_t size,
+        remote_buffer_impl const& dst, std::size_t offset, std::size_t* scheduled);
+
+    rma_request get(context_impl::heap_type::pointer& ptr, std::size_t size,
+        remote_buffer_impl const& src, std::size_t offset, std::size_t* scheduled);
+
+    void flush(remote_buffer_impl const& dst);
+
+    // rma requests only complete locally and are handled like sends
+    rma_request track_rma(ucs_status_ptr_t ret, rank_type peer, std::size_t* scheduled)
+    {
+        if (reinterpret_cast<std::uintptr_t>(ret) == UCS_OK)
+        {
+            // operation is completed immediately
+            return {};
+        }
+        else if (!UCS_PTR_IS_ERR(ret))
+        {
+            // operation was scheduled
+            auto s = m_req_state_factory.make(m_context, this, scheduled, peer, 0,
+                util::unique_function<void(rank_type, tag_type)>([](rank_type, tag_type) {}), ret,
+                m_mutex);
+            s->create_self_ref();
+            // attach necessary data to the request
+            request_data::construct(ret, s.get());
+            return {std::move(s)};
+        }
+        else
+        {
+            // an error occurred
+            throw std::runtime_error("oomph: ucx error - rma operation failed");
+        }
+    }
+
     void enqueue_send(detail::request_state* d)
     {
         while (!m_send_req_queue.push(d)) {}
@@ -439,6 +595,7 @@ class communicator_impl : public communicator_base<communicator_impl>
     //bool cancel_recv_cb(recv_request const& req)
     bool cancel_recv(detail::request_state* s)
     {
+        if (s->m_loopback) return cancel_loopback(s);
         if (m_thread_safe) m_mutex.lock();
         ucp_request_cancel(m_recv_worker->get(), s->m_ucx_ptr);
         //if (m_thread_safe) m_mutex.unlock();
@@ -99,6 +99,7 @@ const char*
 context_impl::get_transport_option(const std::string& opt) const
 {
     if (opt == "name") { return "ucx"; }
+    else if (opt == "rendezvous_threshold") { return m_thresholds.rndv_string(); }
     else { return "unspecified"; }
 }
 
@@ -11,6 +11,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include <boost/lockfree/queue.hpp>
 
@@ -35,6 +36,8 @@ namespace oomph
 #define OOMPH_UCX_ANY_SOURCE_MASK      0x0000000000000000ul
 #define OOMPH_UCX_SPECIFIC_SOURCE_MASK 0x00000000fffffffful
 #define OOMPH_UCX_TAG_MASK             0xffffffff00000000ul
+// set in the tags of the internal messages of the library, never in user tags
+#define OOMPH_UCX_INTERNAL_TAG         0x8000000000000000ul
 
 class context_impl : public context_base
 {
@@ -91,6 +94,10 @@ class context_impl : public context_base
         // read run-time context
         ucp_config_t* config_ptr;
         OOMPH_CHECK_UCX_RESULT(ucp_config_read(NULL, NULL, &config_ptr));
+        // protocol threshold of the context, takes precedence over UCX_RNDV_THRESH
+        if (m_thresholds.rndv() > 0u)
+            OOMPH_CHECK_UCX_RESULT(ucp_config_modify(config_ptr, "RNDV_THRESH",
+                std::to_string(m_thresholds.rndv()).c_str()));
 
         // set parameters
         ucp_params_t context_params;
@@ -170,6 +177,8 @@ class context_impl : public context_base
 
     auto& get_heap() noexcept { return m_heap; }
 
+    auto& get_rma_context() noexcept { return m_rma_context; }
+
     communicator_impl* get_communicator();
 
     void progress()
@@ -178,6 +187,8 @@ class context_impl : public context_base
         //    ucx_lock lock(m_mutex);
         //    while (ucp_worker_progress(m_worker->get())) {}
         //}
+        m_loopback.progress_any_source(m_any_source, rank());
+        m_loopback.progress_shared();
         if (m_mutex.try_lock())
         {
             ucp_worker_progress(m_worker->get());
@@ -203,6 +214,7 @@ class context_impl : public context_base
 
     bool cancel_recv(detail::shared_request_state* s)
     {
+        if (s->m_loopback) return m_loopback.cancel(s) || m_any_source.cancel(s);
         if (m_thread_safe) m_mutex.lock();
         ucp_request_cancel(m_worker->get(), s->m_ucx_ptr);
         while (ucp_worker_progress(m_worker->get())) {}
@@ -240,7 +252,8 @@ class context_impl : public context_base
 
     const char* get_transport_option(const std::string& opt) const;
 
-    unsigned int num_tag_bits() const noexcept { return OOMPH_UCX_TAG_BITS; }
+    // the most significant tag bit marks the internal messages
+    unsigned int num_tag_bits() const noexcept { return OOMPH_UCX_TAG_BITS - 1; }
 };
 
 template<>
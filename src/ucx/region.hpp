@@ -113,6 +113,8 @@ class rma_region
         if (m_ptr) { ucp_mem_unmap(m_ucp_context, m_memh); }
     }
 
+    ucp_mem_h get_memh() const noexcept { return m_memh; }
+
     // get a handle to some portion of the region
     handle_type get_handle(std::size_t offset, std::size_t size)
     {
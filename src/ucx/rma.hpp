@@ -0,0 +1,121 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstring>
+#include <stdexcept>
+
+#include <oomph/rma.hpp>
+
+// paths relative to backend
+#include <communicator.hpp>
+
+namespace oomph
+{
+// Memory is mapped through the rma context and the packed remote key is stored in the descriptor.
+class exposed_buffer_impl
+{
+  private:
+    rma_region     m_region;
+    rma_descriptor m_descriptor;
+
+  public:
+    exposed_buffer_impl(communicator_impl* comm, context_impl::heap_type::pointer& ptr,
+        std::size_t size)
+    : m_region{make_region(comm, ptr, size)}
+    {
+        void*       rkey_buffer;
+        std::size_t rkey_size;
+        OOMPH_CHECK_UCX_RESULT(
+            ucp_rkey_pack(comm->m_context->get(), m_region.get_memh(), &rkey_buffer, &rkey_size));
+        if (rkey_size > rma_descriptor::max_key_size)
+        {
+            ucp_rkey_buffer_release(rkey_buffer);
+            throw std::runtime_error("oomph: ucx error - packed remote key is too large");
+        }
+        m_descriptor.m_rank = comm->rank();
+        m_descriptor.m_address = reinterpret_cast<std::uint64_t>(m_region.get_handle(0, 0).m_ptr);
+        m_descriptor.m_size = size;
+        m_descriptor.m_key_size = rkey_size;
+        std::memcpy(m_descriptor.m_key, rkey_buffer, rkey_size);
+        ucp_rkey_buffer_release(rkey_buffer);
+    }
+
+    rma_descriptor const& descriptor() const noexcept { return m_descriptor; }
+
+  private:
+    static rma_region make_region(communicator_impl* comm, context_impl::heap_type::pointer& ptr,
+        std::size_t size)
+    {
+        device_guard dg(ptr);
+        return comm->m_context->get_rma_context().make_region(dg.data(), size, dg.m_on_device);
+    }
+};
+
+// The remote key is unpacked on the endpoint of the communicator's send worker.
+class remote_buffer_impl
+{
+  public:
+    rank_type     m_rank;
+    std::uint64_t m_address;
+    ucp_ep_h      m_ep;
+    ucp_rkey_h    m_rkey;
+
+  public:
+    remote_buffer_impl(communicator_impl* comm, rma_descriptor const& d)
+    : m_rank{d.m_rank}
+    , m_address{d.m_address}
+    , m_ep{comm->m_send_worker->connect(d.m_rank).get()}
+    {
+        OOMPH_CHECK_UCX_RESULT(ucp_ep_rkey_unpack(m_ep, d.m_key, &m_rkey));
+    }
+
+    remote_buffer_impl(remote_buffer_impl const&) = delete;
+
+    ~remote_buffer_impl() { ucp_rkey_destroy(m_rkey); }
+};
+
+inline rma_request
+communicator_impl::put(context_impl::heap_type::pointer const& ptr, std::size_t size,
+    remote_buffer_impl const& dst, std::size_t offset, std::size_t* scheduled)
+{
+    ucs_status_ptr_t ret;
+    {
+        const_device_guard dg(ptr);
+        ret = ucp_put_nb(dst.m_ep, dg.data(), size, dst.m_address + offset, dst.m_rkey,
+            &communicator_impl::send_callback);
+    }
+    return track_rma(ret, dst.m_rank, scheduled);
+}
+
+inline rma_request
+communicator_impl::get(context_impl::heap_type::pointer& ptr, std::size_t size,
+    remote_buffer_impl const& src, std::size_t offset, std::size_t* scheduled)
+{
+    ucs_status_ptr_t ret;
+    {
+        device_guard dg(ptr);
+        ret = ucp_get_nb(src.m_ep, dg.data(), size, src.m_address + offset, src.m_rkey,
+            &communicator_impl::send_callback);
+    }
+    return track_rma(ret, src.m_rank, scheduled);
+}
+
+inline void
+communicator_impl::flush(remote_buffer_impl const& dst)
+{
+    auto ret = ucp_ep_flush_nb(dst.m_ep, 0, [](void*, ucs_status_t) {});
+    if (reinterpret_cast<std::uintptr_t>(ret) == UCS_OK) return;
+    if (UCS_PTR_IS_ERR(ret)) throw std::runtime_error("oomph: ucx error - flush operation failed");
+    while (ucp_request_check_status(ret) == UCS_INPROGRESS) progress();
+    ucp_request_free(ret);
+}
+
+} // namespace oomph
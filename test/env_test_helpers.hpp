@@ -0,0 +1,63 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdlib>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <oomph/context.hpp>
+
+namespace oomph::test
+{
+// sets environment variables for its lifetime and restores their previous values afterwards
+class scoped_env
+{
+  private:
+    std::vector<std::pair<std::string, std::optional<std::string>>> m_saved;
+
+  public:
+    scoped_env(std::initializer_list<std::pair<char const*, std::string>> vars)
+    {
+        for (auto const& [name, value] : vars)
+        {
+            auto const old = std::getenv(name);
+            m_saved.emplace_back(name,
+                old ? std::optional<std::string>(old) : std::optional<std::string>());
+            setenv(name, value.c_str(), 1);
+        }
+    }
+
+    scoped_env(scoped_env const&) = delete;
+    scoped_env& operator=(scoped_env const&) = delete;
+
+    ~scoped_env()
+    {
+        for (auto it = m_saved.rbegin(); it != m_saved.rend(); ++it)
+        {
+            if (it->second) setenv(it->first.c_str(), it->second->c_str(), 1);
+            else
+                unsetenv(it->first.c_str());
+        }
+    }
+};
+
+// creates a context on MPI_COMM_WORLD with the given environment, which configures the context when
+// it is created
+inline oomph::context
+make_context(std::initializer_list<std::pair<char const*, std::string>> vars)
+{
+    scoped_env env(vars);
+    return oomph::context(MPI_COMM_WORLD, false);
+}
+} // namespace oomph::test
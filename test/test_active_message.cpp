@@ -0,0 +1,243 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+#include <vector>
+
+const int num_msgs = 10;
+
+struct am_header
+{
+    int m_rank;
+    int m_index;
+};
+
+// every rank sends num_msgs active messages with n payload elements to the next rank
+void
+test_ring(oomph::communicator& comm, std::size_t n)
+{
+    using namespace oomph;
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    std::vector<int> seen(num_msgs, 0);
+    comm.register_am(1,
+        [&](am_message const& m)
+        {
+            EXPECT_EQ(m.m_src, src);
+            EXPECT_EQ(m.m_id, 1u);
+            ASSERT_EQ(m.m_header_size, sizeof(am_header));
+            auto const h = m.header<am_header>();
+            EXPECT_EQ(h->m_rank, src);
+            ASSERT_EQ(m.payload_size<int>(), n);
+            for (std::size_t i = 0; i < n; ++i) EXPECT_EQ(m.payload<int>()[i], h->m_index);
+            ++seen[h->m_index];
+        });
+
+    std::vector<message_buffer<int>> payloads;
+    std::vector<send_request>        reqs;
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        payloads.push_back(comm.make_buffer<int>(n));
+        for (auto& x : payloads.back()) x = i;
+        am_header h{comm.rank(), i};
+        reqs.push_back(comm.send_am(dst, 1, &h, sizeof(h), payloads.back()));
+    }
+    int received = 0;
+    while (received < num_msgs)
+    {
+        comm.progress();
+        received = 0;
+        for (auto x : seen) received += x;
+    }
+    for (auto& r : reqs) r.wait();
+    for (auto x : seen) EXPECT_EQ(x, 1);
+}
+
+TEST_F(mpi_test_fixture, active_message_eager)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    test_ring(comm, 16);
+}
+
+TEST_F(mpi_test_fixture, active_message_rendezvous)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    // larger than the eager size
+    test_ring(comm, 16 * 1024);
+}
+
+TEST_F(mpi_test_fixture, active_message_self)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    int count = 0;
+    comm.register_am(2,
+        [&](am_message const& m)
+        {
+            EXPECT_EQ(m.m_src, comm.rank());
+            EXPECT_EQ(*m.header<int>(), count);
+            EXPECT_EQ(m.m_payload_size, 0u);
+            ++count;
+        });
+    for (int i = 0; i < num_msgs; ++i) comm.send_am(comm.rank(), 2, &i, sizeof(i)).wait();
+    while (count < num_msgs) comm.progress();
+    EXPECT_EQ(count, num_msgs);
+}
+
+TEST_F(mpi_test_fixture, active_message_reply)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false);
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+
+    // handlers may send active messages
+    int requests = 0;
+    int replies = 0;
+    comm.register_am(3,
+        [&](am_message const& m)
+        {
+            comm.send_am(m.m_src, 4, nullptr, 0u);
+            ++requests;
+        });
+    comm.register_am(4, [&](am_message const&) { ++replies; });
+    comm.send_am(dst, 3, nullptr, 0u);
+    while (requests < 1 || replies < 1) comm.progress();
+    comm.wait_all();
+}
+
+// communicators of different tag ranges use active messages side by side
+TEST_F(mpi_test_fixture, active_message_tag_ranges)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false, 2);
+    auto       comm0 = ctxt.get_communicator(0);
+    auto       comm1 = ctxt.get_communicator(1);
+    auto const dst = (comm0.rank() + 1) % comm0.size();
+    auto const src = (comm0.rank() + comm0.size() - 1) % comm0.size();
+    // larger than the eager size
+    std::size_t const n = 16 * 1024;
+
+    std::vector<communicator*>       comms{&comm0, &comm1};
+    std::vector<int>                 seen(2 * num_msgs, 0);
+    std::vector<message_buffer<int>> payloads;
+    std::vector<send_request>        reqs;
+    for (int c = 0; c < 2; ++c)
+        comms[c]->register_am(1,
+            [&seen, c, src, n](am_message const& m)
+            {
+                EXPECT_EQ(m.m_src, src);
+                auto const h = m.header<am_header>();
+                ASSERT_EQ(m.payload_size<int>(), n);
+                // the payload identifies the communicator
+                for (std::size_t i = 0; i < n; ++i)
+                    EXPECT_EQ(m.payload<int>()[i], c * num_msgs + h->m_index);
+                ++seen[c * num_msgs + h->m_index];
+            });
+    // interleave the messages of both communicators
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            payloads.push_back(comms[c]->make_buffer<int>(n));
+            for (auto& x : payloads.back()) x = c * num_msgs + i;
+            am_header h{comm0.rank(), i};
+            reqs.push_back(comms[c]->send_am(dst, 1, &h, sizeof(h), payloads.back()));
+        }
+    }
+    int received = 0;
+    while (received < 2 * num_msgs)
+    {
+        comm0.progress();
+        comm1.progress();
+        received = 0;
+        for (auto x : seen) received += x;
+    }
+    for (auto& r : reqs) r.wait();
+    for (auto x : seen) EXPECT_EQ(x, 1);
+    MPI_Barrier(MPI_COMM_WORLD);
+    comm0.wait_all();
+    comm1.wait_all();
+}
+
+// communicators of the same tag range (e.g. one per thread) use active messages side by side, with
+// the same handlers, and receives of the user from any source with any tag do not match them
+TEST_F(mpi_test_fixture, active_message_same_tag_range)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false);
+    auto       comm0 = ctxt.get_communicator();
+    auto       comm1 = ctxt.get_communicator();
+    auto const dst = (comm0.rank() + 1) % comm0.size();
+    auto const src = (comm0.rank() + comm0.size() - 1) % comm0.size();
+
+    auto user_msg = comm0.make_buffer<int>(1);
+    auto user_req = comm0.recv(user_msg, communicator::any_source, communicator::any_tag);
+
+    std::vector<communicator*>       comms{&comm0, &comm1};
+    std::vector<int>                 seen(2 * num_msgs, 0);
+    std::vector<message_buffer<int>> payloads;
+    std::vector<send_request>        reqs;
+    for (auto c : comms)
+        c->register_am(1,
+            [&seen, src](am_message const& m)
+            {
+                EXPECT_EQ(m.m_src, src);
+                auto const h = m.header<am_header>();
+                for (std::size_t i = 0; i < m.payload_size<int>(); ++i)
+                    EXPECT_EQ(m.payload<int>()[i], h->m_index);
+                ++seen[h->m_index];
+            });
+    // eager and rendezvous messages from both communicators
+    for (int i = 0; i < 2 * num_msgs; ++i)
+    {
+        auto const n = (i % 2) ? std::size_t(16 * 1024) : std::size_t(16);
+        payloads.push_back(comms[i % 2]->make_buffer<int>(n));
+        for (auto& x : payloads.back()) x = i;
+        am_header h{comm0.rank(), i};
+        reqs.push_back(comms[i % 2]->send_am(dst, 1, &h, sizeof(h), payloads.back()));
+    }
+    int received = 0;
+    while (received < 2 * num_msgs)
+    {
+        comm0.progress();
+        comm1.progress();
+        received = 0;
+        for (auto x : seen) received += x;
+    }
+    for (auto& r : reqs) r.wait();
+    for (auto x : seen) EXPECT_EQ(x, 1);
+    EXPECT_FALSE(user_req.is_ready());
+
+    auto msg = comm1.make_buffer<int>(1);
+    msg[0] = 42;
+    auto send_req = comm1.send(msg, dst, 5);
+    user_req.wait();
+    send_req.wait();
+    EXPECT_EQ(user_msg[0], 42);
+    MPI_Barrier(MPI_COMM_WORLD);
+    comm0.wait_all();
+    comm1.wait_all();
+}
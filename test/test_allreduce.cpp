@@ -0,0 +1,56 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+
+const std::size_t size = 8;
+
+TEST_F(mpi_test_fixture, allreduce_sum)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    auto msg = comm.make_buffer<double>(size);
+    for (int iter = 0; iter < 10; ++iter)
+    {
+        for (std::size_t i = 0; i < size; ++i) msg[i] = comm.rank() + i + iter;
+        comm.allreduce(msg, reduce_op::sum, 0).wait();
+        auto const n = comm.size();
+        for (std::size_t i = 0; i < size; ++i)
+            EXPECT_EQ(msg[i], (double)(n * (n - 1) / 2 + n * (i + iter)));
+    }
+}
+
+TEST_F(mpi_test_fixture, allreduce_min_max)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    auto msg_min = comm.make_buffer<int>(size);
+    auto msg_max = comm.make_buffer<int>(size);
+    for (std::size_t i = 0; i < size; ++i) msg_min[i] = msg_max[i] = comm.rank() * (int)i;
+
+    // two operations in flight at the same time, completed through progress
+    auto r_min = comm.allreduce(msg_min, reduce_op::min, 1);
+    auto r_max = comm.allreduce(msg_max, reduce_op::max, 2);
+    while (!(r_min.is_ready() && r_max.is_ready())) comm.progress();
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        EXPECT_EQ(msg_min[i], 0);
+        EXPECT_EQ(msg_max[i], (comm.size() - 1) * (int)i);
+    }
+}
@@ -171,3 +171,57 @@ TEST_F(mpi_test_fixture, full_barrier_sendrecv)
         oomph::test::handle_nccl_thread_safe_exception(e);
     }
 }
+
+TEST_F(mpi_test_fixture, split_phase_rank_barrier)
+{
+    using namespace oomph;
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    barrier b(ctxt);
+    for (int i = 0; i < 20; i++)
+    {
+        auto t = b.arrive();
+        while (!b.test(t)) {}
+        EXPECT_TRUE(b.test(t));
+    }
+    for (int i = 0; i < 20; i++)
+    {
+        auto t = b.arrive();
+        b.wait(t);
+    }
+}
+
+TEST_F(mpi_test_fixture, split_phase_barrier)
+{
+    using namespace oomph;
+    try {
+        auto ctxt = context(MPI_COMM_WORLD, true);
+
+        std::size_t      n_threads = 4;
+        barrier          b(ctxt, n_threads);
+        std::atomic<int> count{0};
+
+        auto work = [&]()
+        {
+            auto comm = ctxt.get_communicator();
+            for (int i = 0; i < 10; i++)
+            {
+                ++count;
+                auto t = b.arrive();
+                comm.progress();
+                b.wait(t);
+                EXPECT_GE(count.load(), (int)((i + 1) * n_threads));
+                // keep the next increment from racing with the check above
+                b.thread_barrier();
+            }
+        };
+
+        std::vector<std::thread> ths;
+        for (size_t i = 0; i < n_threads; ++i) { ths.push_back(std::thread{work}); }
+        for (size_t i = 0; i < n_threads; ++i) { ths[i].join(); }
+        EXPECT_EQ(count.load(), (int)(10 * n_threads));
+    } catch (std::runtime_error const& e) {
+        oomph::test::handle_nccl_thread_safe_exception(e);
+    }
+}
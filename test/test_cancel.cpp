@@ -185,3 +185,44 @@ TEST_F(mpi_test_fixture, test_cancel_cb_mt)
         oomph::test::handle_nccl_thread_safe_exception(e);
     }
 }
+
+// the message may have been matched by the transport before the receive is canceled: the cancel
+// then fails and the receive completes as usual
+TEST_F(mpi_test_fixture, test_cancel_completed)
+{
+    using namespace oomph;
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    if (ctxt.get_transport_option("name") == std::string("nccl"))
+    {
+        GTEST_SKIP() << "NCCL does not support cancellation";
+    }
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+    auto       smsg = comm.make_buffer<int>(1);
+    auto       rmsg = comm.make_buffer<int>(1);
+    using msg_t = decltype(rmsg);
+    smsg[0] = comm.rank();
+    rmsg[0] = -1;
+
+    int  counter = 0;
+    auto h = comm.recv(rmsg, src, 42, [&counter](msg_t&, int, int) { ++counter; });
+    auto s = comm.send(smsg, dst, 42);
+    // the transport progresses inside the barrier, the communicator does not
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (h.cancel())
+    {
+        EXPECT_EQ(counter, 0);
+        comm.recv(rmsg, src, 42).wait();
+    }
+    else
+    {
+        h.wait();
+        EXPECT_EQ(counter, 1);
+    }
+    s.wait();
+    EXPECT_EQ(rmsg[0], src);
+    EXPECT_EQ(comm.scheduled_sends(), 0u);
+    EXPECT_EQ(comm.scheduled_recvs(), 0u);
+}
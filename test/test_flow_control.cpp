@@ -0,0 +1,108 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+#include "./env_test_helpers.hpp"
+#include <string>
+#include <vector>
+
+const int         num_msgs = 100;
+const std::size_t size = 16;
+
+TEST_F(mpi_test_fixture, flow_control_defer)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = oomph::test::make_context({{"OOMPH_FLOW_CREDITS", "4"}});
+    auto comm = ctxt.get_communicator();
+    if (comm.size() < 2) GTEST_SKIP();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    std::vector<message_buffer<int>> smsgs;
+    std::vector<send_request>        sreqs;
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        smsgs.push_back(comm.make_buffer<int>(size));
+        for (auto& x : smsgs.back()) x = i;
+        sreqs.push_back(comm.send(smsgs.back(), dst, 1));
+    }
+    for (int i = 0; i < 10; ++i) comm.progress();
+    // no receive is posted yet: the sends beyond the credits are held back
+    EXPECT_FALSE(sreqs.back().is_ready());
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    std::vector<message_buffer<int>> rmsgs;
+    std::vector<recv_request>        rreqs;
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        rmsgs.push_back(comm.make_buffer<int>(size));
+        rreqs.push_back(comm.recv(rmsgs.back(), src, 1));
+    }
+    for (auto& r : rreqs) r.wait();
+    for (auto& r : sreqs) r.wait();
+    // messages are received in order
+    for (int i = 0; i < num_msgs; ++i)
+        for (auto x : rmsgs[i]) EXPECT_EQ(x, i);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, flow_control_callbacks)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = oomph::test::make_context({{"OOMPH_FLOW_CREDITS", "1"}});
+    // the libfabric backend cannot probe for messages
+    if (std::string(ctxt.get_transport_option("name")) == "libfabric") GTEST_SKIP();
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    // receives of unknown size from any source return credits as well
+    int received = 0;
+    int sent = 0;
+    for (int i = 0; i < num_msgs; ++i)
+        comm.recv_any_size<int>(communicator::any_source, 2,
+            [&](message_buffer<int> msg, rank_type r, tag_type)
+            {
+                EXPECT_EQ(r, src);
+                EXPECT_EQ(msg.size(), size);
+                ++received;
+            });
+    for (int i = 0; i < num_msgs; ++i)
+        comm.send(comm.make_buffer<int>(size), dst, 2,
+            [&sent](message_buffer<int>, rank_type, tag_type) { ++sent; });
+    while (received < num_msgs || sent < num_msgs) comm.progress();
+    EXPECT_TRUE(comm.is_ready());
+}
+
+// receives which cannot return credits would leave the sender waiting forever
+TEST_F(mpi_test_fixture, flow_control_wildcards)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = oomph::test::make_context({{"OOMPH_FLOW_CREDITS", "4"}});
+    auto       comm = ctxt.get_communicator();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+    auto       msg = comm.make_buffer<int>(size);
+
+    EXPECT_THROW(comm.recv(msg, communicator::any_source, 1), std::runtime_error);
+    EXPECT_THROW(comm.recv(msg, src, communicator::any_tag), std::runtime_error);
+    EXPECT_THROW(comm.shared_recv(msg, src, 1), std::runtime_error);
+    EXPECT_THROW(comm.shared_recv(msg, communicator::any_source, 1), std::runtime_error);
+    EXPECT_TRUE(comm.is_ready());
+
+    // messages to self are not counted
+    auto r = comm.recv(msg, comm.rank(), communicator::any_tag);
+    comm.send(comm.make_buffer<int>(size), comm.rank(), 1).wait();
+    r.wait();
+}
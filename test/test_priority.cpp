@@ -0,0 +1,146 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+#include "./env_test_helpers.hpp"
+#include <string>
+#include <vector>
+
+const int         num_msgs = 20;
+const std::size_t size = 64;
+
+// every message of a lane carries its lane (0: normal, 1: high) and its index
+void
+fill(oomph::message_buffer<int>& msg, int lane, int i)
+{
+    for (auto& x : msg) x = lane * 1000 + i;
+}
+
+TEST_F(mpi_test_fixture, priority_ring)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = oomph::test::make_context({{"OOMPH_MPI_PRIORITY_LANE", "1"}});
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    // both lanes use the same tag, and the receives are posted in the order of the sends
+    std::vector<message_buffer<int>> rmsgs;
+    std::vector<recv_request>        rreqs;
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        rmsgs.push_back(comm.make_buffer<int>(size));
+        rreqs.push_back(comm.recv(rmsgs.back(), src, 3));
+        rmsgs.push_back(comm.make_buffer<int>(size));
+        rreqs.push_back(comm.recv(rmsgs.back(), src, 3, priority::high));
+    }
+
+    std::vector<message_buffer<int>> smsgs;
+    std::vector<send_request>        sreqs;
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        smsgs.push_back(comm.make_buffer<int>(size));
+        fill(smsgs.back(), 0, i);
+        sreqs.push_back(comm.send(smsgs.back(), dst, 3));
+        smsgs.push_back(comm.make_buffer<int>(size));
+        fill(smsgs.back(), 1, i);
+        sreqs.push_back(comm.send(smsgs.back(), dst, 3, priority::high));
+    }
+
+    for (auto& r : rreqs) r.wait();
+    for (auto& r : sreqs) r.wait();
+    for (int i = 0; i < 2 * num_msgs; ++i)
+        for (auto x : rmsgs[i]) EXPECT_EQ(x, (i % 2) * 1000 + i / 2);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, priority_callbacks)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = oomph::test::make_context({{"OOMPH_MPI_PRIORITY_LANE", "1"}});
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    // messages are passed on to the next rank from the callbacks, including to self
+    int received = 0;
+    int sent = 0;
+    for (auto peer : {src, comm.rank()})
+        comm.recv(comm.make_buffer<int>(size), peer, 5,
+            [&received, peer](message_buffer<int> msg, rank_type r, tag_type t)
+            {
+                EXPECT_EQ(r, peer);
+                EXPECT_EQ(t, 5);
+                for (auto x : msg) EXPECT_EQ(x, 1000 + r);
+                ++received;
+            },
+            priority::high);
+    for (auto peer : {dst, comm.rank()})
+    {
+        auto msg = comm.make_buffer<int>(size);
+        fill(msg, 1, comm.rank());
+        comm.send(std::move(msg), peer, 5,
+            [&sent](message_buffer<int>, rank_type, tag_type) { ++sent; }, priority::high);
+    }
+    while (received < 2 || sent < 2) comm.progress();
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, priority_cancel)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = oomph::test::make_context({{"OOMPH_MPI_PRIORITY_LANE", "1"}});
+    auto comm = ctxt.get_communicator();
+
+    auto msg = comm.make_buffer<int>(size);
+    auto req = comm.recv(msg, communicator::any_source, 9, priority::high);
+    comm.progress();
+    EXPECT_TRUE(req.cancel());
+    EXPECT_TRUE(req.is_canceled());
+    EXPECT_TRUE(comm.is_ready());
+}
+
+// with a separate lane, a message with priority::high is only matched by a receive with
+// priority::high, otherwise by any receive
+TEST_F(mpi_test_fixture, priority_lanes)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    for (auto lane : {"0", "1"})
+    {
+        auto       ctxt = oomph::test::make_context({{"OOMPH_MPI_PRIORITY_LANE", lane}});
+        auto       comm = ctxt.get_communicator();
+        auto const dst = (comm.rank() + 1) % comm.size();
+        auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+        auto const separate = std::string(ctxt.get_transport_option("name")) == "mpi" &&
+                              std::string(lane) == "1";
+
+        auto rmsg_0 = comm.make_buffer<int>(size);
+        auto rmsg_1 = comm.make_buffer<int>(size);
+        auto smsg_0 = comm.make_buffer<int>(size);
+        auto smsg_1 = comm.make_buffer<int>(size);
+        fill(smsg_0, 0, 0);
+        fill(smsg_1, 1, 0);
+        auto r_0 = comm.recv(rmsg_0, src, 4);
+        auto r_1 = comm.recv(rmsg_1, src, 4, priority::high);
+        comm.send(smsg_1, dst, 4, priority::high).wait();
+        comm.send(smsg_0, dst, 4).wait();
+        r_0.wait();
+        r_1.wait();
+        for (auto x : rmsg_0) EXPECT_EQ(x, separate ? 0 : 1000);
+        for (auto x : rmsg_1) EXPECT_EQ(x, separate ? 1000 : 0);
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+}
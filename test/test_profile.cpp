@@ -0,0 +1,67 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+#include "./env_test_helpers.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+std::string
+write_profile(int rank)
+{
+    auto const    file_name = "oomph_test_profile_" + std::to_string(rank) + ".txt";
+    std::ofstream file(file_name);
+    file << "# test profile\n";
+    file << "OOMPH_RNDV_THRESHOLD=8192\n";
+    file << "OOMPH_INJECT_THRESHOLD=16\n";
+    return file_name;
+}
+
+TEST_F(mpi_test_fixture, profile_thresholds)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto const file_name = write_profile(world_rank);
+    {
+        auto              ctxt = oomph::test::make_context({{"OOMPH_PROFILE", file_name}});
+        std::string const name = ctxt.get_transport_option("name");
+        if (name == "ucx")
+        { EXPECT_EQ(std::string(ctxt.get_transport_option("rendezvous_threshold")), "8192"); }
+        else if (name == "libfabric")
+        { EXPECT_LE(std::stoul(ctxt.get_transport_option("inject_threshold")), 16ul); }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    // the environment takes precedence over the profile
+    {
+        auto ctxt = oomph::test::make_context(
+            {{"OOMPH_PROFILE", file_name}, {"OOMPH_RNDV_THRESHOLD", "4096"}});
+        std::string const name = ctxt.get_transport_option("name");
+        if (name == "ucx")
+        { EXPECT_EQ(std::string(ctxt.get_transport_option("rendezvous_threshold")), "4096"); }
+
+        // messages are still delivered
+        auto       comm = ctxt.get_communicator();
+        auto const dst = (comm.rank() + 1) % comm.size();
+        auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+        auto       smsg = comm.make_buffer<int>(10000);
+        auto       rmsg = comm.make_buffer<int>(10000);
+        for (auto& x : smsg) x = comm.rank();
+        auto rreq = comm.recv(rmsg, src, 0);
+        comm.send(smsg, dst, 0).wait();
+        rreq.wait();
+        for (auto x : rmsg) EXPECT_EQ(x, src);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    std::remove(file_name.c_str());
+}
@@ -0,0 +1,153 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./env_test_helpers.hpp"
+#include <string>
+#include <vector>
+
+const int num_msgs = 10;
+
+// the libfabric and NCCL backends cannot probe for messages
+bool
+any_size_supported()
+{
+    auto const        ctxt = oomph::context(MPI_COMM_WORLD, false);
+    std::string const name = ctxt.get_transport_option("name");
+    return (name == "mpi") || (name == "ucx");
+}
+
+// message i holds i*100 copies of i
+std::size_t
+msg_size(int i)
+{
+    return i * 100;
+}
+
+void
+test_ring(oomph::communicator& comm, oomph::rank_type src, oomph::tag_type tag)
+{
+    using namespace oomph;
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const expected_src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    std::vector<int> seen(num_msgs, 0);
+    auto             consume = [&](message_buffer<int> msg, rank_type r, tag_type t)
+    {
+        EXPECT_EQ(r, expected_src);
+        ASSERT_TRUE(t >= 0 && t < num_msgs);
+        ASSERT_EQ(msg.size(), msg_size(t));
+        for (auto x : msg) EXPECT_EQ(x, t);
+        ++seen[t];
+    };
+
+    std::vector<recv_request> rreqs;
+    for (int i = 0; i < num_msgs; ++i)
+        rreqs.push_back(comm.recv_any_size<int>(src, tag < 0 ? tag : i, consume));
+
+    std::vector<message_buffer<int>> msgs;
+    std::vector<send_request>        sreqs;
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        msgs.push_back(comm.make_buffer<int>(msg_size(i)));
+        for (auto& x : msgs.back()) x = i;
+        sreqs.push_back(comm.send(msgs.back(), dst, i));
+    }
+    for (auto& r : rreqs) r.wait();
+    for (auto& r : sreqs) r.wait();
+    for (auto x : seen) EXPECT_EQ(x, 1);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, recv_any_size)
+{
+    using namespace oomph;
+    if (!any_size_supported()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false);
+    auto       comm = ctxt.get_communicator();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+    test_ring(comm, src, 0);
+}
+
+TEST_F(mpi_test_fixture, recv_any_size_any_source)
+{
+    using namespace oomph;
+    if (!any_size_supported()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    if (comm.size() < 2) GTEST_SKIP();
+    test_ring(comm, communicator::any_source, communicator::any_tag);
+}
+
+TEST_F(mpi_test_fixture, recv_any_size_self)
+{
+    using namespace oomph;
+    if (!any_size_supported()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    std::size_t received = 0;
+    auto        smsg = comm.make_buffer<double>(42);
+    for (auto& x : smsg) x = 1.5;
+    comm.send(smsg, comm.rank(), 7).wait();
+    auto req = comm.recv_any_size<double>(comm.rank(), 7,
+        [&](message_buffer<double> msg, rank_type r, tag_type t)
+        {
+            EXPECT_EQ(r, comm.rank());
+            EXPECT_EQ(t, 7);
+            for (auto x : msg) EXPECT_EQ(x, 1.5);
+            received = msg.size();
+        });
+    req.wait();
+    EXPECT_EQ(received, 42u);
+}
+
+TEST_F(mpi_test_fixture, recv_any_size_cancel)
+{
+    using namespace oomph;
+    if (!any_size_supported()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    bool called = false;
+    auto req = comm.recv_any_size<int>(communicator::any_source, 9,
+        [&called](message_buffer<int>, rank_type, tag_type) { called = true; });
+    comm.progress();
+    EXPECT_TRUE(req.cancel());
+    EXPECT_TRUE(req.is_canceled());
+    EXPECT_FALSE(called);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+// a probe with any_tag must not take the messages of another tag range
+TEST_F(mpi_test_fixture, recv_any_size_tag_ranges)
+{
+    using namespace oomph;
+    if (!any_size_supported()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false, 2);
+    auto       comm = ctxt.get_communicator(1);
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+    auto const cb = [](message_buffer<int>, rank_type, tag_type) {};
+    if (std::string(ctxt.get_transport_option("name")) == "mpi")
+        EXPECT_THROW(comm.recv_any_size<int>(src, communicator::any_tag, cb), std::runtime_error);
+    EXPECT_TRUE(comm.is_ready());
+
+    // with a matching communicator per tag range
+    auto pool_ctxt = [] {
+        oomph::test::scoped_env env({{"OOMPH_MPI_COMM_POOL_SIZE", "2"}});
+        return context(MPI_COMM_WORLD, false, 2);
+    }();
+
+    auto pool_comm_0 = pool_ctxt.get_communicator(0);
+    auto pool_comm_1 = pool_ctxt.get_communicator(1);
+    test_ring(pool_comm_1, src, communicator::any_tag);
+    test_ring(pool_comm_0, src, 0);
+}
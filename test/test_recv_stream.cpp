@@ -0,0 +1,115 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+#include <vector>
+
+const std::size_t size = 1024;
+const std::size_t depth = 4;
+const int         num_msgs = 20;
+
+TEST_F(mpi_test_fixture, recv_stream_ring)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false);
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    std::vector<int> seen(num_msgs, 0);
+    auto             stream = comm.make_recv_stream<int>(src, 1, size, depth,
+        [&](recv_lease<int> l)
+        {
+            EXPECT_EQ(l.src(), src);
+            EXPECT_EQ(l.tag(), 1);
+            auto const i = (*l)[0];
+            ASSERT_TRUE(i >= 0 && i < num_msgs);
+            for (auto x : *l) EXPECT_EQ(x, i);
+            ++seen[i];
+            // the buffer is posted again when the lease goes out of scope
+        });
+    EXPECT_EQ(stream.depth(), depth);
+    EXPECT_EQ(stream.posted(), depth);
+
+    // more messages than posted receives
+    auto smsg = comm.make_buffer<int>(size);
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        for (auto& x : smsg) x = i;
+        comm.send(smsg, dst, 1).wait();
+    }
+    while (stream.received() < (std::size_t)num_msgs) comm.progress();
+
+    for (auto n : seen) EXPECT_EQ(n, 1);
+    EXPECT_EQ(stream.posted(), depth);
+
+    stream.close();
+    EXPECT_EQ(comm.scheduled_recvs(), 0u);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, recv_stream_lease)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false);
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    // leases are kept beyond the callback: no receive is posted until they are released
+    std::vector<recv_lease<int>> leases;
+    auto                         stream = comm.make_recv_stream<int>(src, 2, size, depth,
+        [&leases](recv_lease<int> l) { leases.push_back(std::move(l)); });
+
+    auto smsg = comm.make_buffer<int>(size);
+    for (std::size_t i = 0; i < depth; ++i)
+    {
+        for (auto& x : smsg) x = i;
+        comm.send(smsg, dst, 2).wait();
+    }
+    while (leases.size() < depth) comm.progress();
+    EXPECT_EQ(stream.posted(), 0u);
+
+    for (auto& l : leases) l.release();
+    EXPECT_EQ(stream.posted(), depth);
+
+    // a lease may outlive the stream
+    comm.send(smsg, dst, 2).wait();
+    while (leases.size() < depth + 1) comm.progress();
+    stream.close();
+    EXPECT_TRUE(comm.is_ready());
+    leases.clear();
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, recv_stream_self)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    int  sum = 0;
+    auto consume = [&sum](recv_lease<int> l) { sum += (*l)[0]; };
+    auto stream = comm.make_recv_stream<int>(comm.rank(), 3, 1, 2, consume);
+
+    auto smsg = comm.make_buffer<int>(1);
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        smsg[0] = i;
+        comm.send(smsg, comm.rank(), 3).wait();
+    }
+    while (stream.received() < (std::size_t)num_msgs) comm.progress();
+    EXPECT_EQ(sum, num_msgs * (num_msgs - 1) / 2);
+}
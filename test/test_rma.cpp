@@ -0,0 +1,133 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./env_test_helpers.hpp"
+#include <string>
+
+const std::size_t size = 1024;
+
+// ranks are paired up; the last one talks to itself if the number of ranks is odd
+oomph::rank_type
+partner(oomph::communicator const& comm)
+{
+    auto const p = comm.rank() ^ 1;
+    return p < comm.size() ? p : comm.rank();
+}
+
+bool
+rma_supported(oomph::context const& ctxt)
+{
+    auto const name = std::string(ctxt.get_transport_option("name"));
+    return (name == "mpi") || (name == "ucx");
+}
+
+TEST_F(mpi_test_fixture, rma_put)
+{
+    using namespace oomph;
+    auto ctxt = oomph::test::make_context({{"OOMPH_MPI_RMA", "1"}});
+    if (!rma_supported(ctxt)) GTEST_SKIP();
+    auto comm = ctxt.get_communicator();
+    // the window may not be available on a single rank, see rma_single_rank
+    if (comm.size() == 1) GTEST_SKIP();
+
+    auto const peer = partner(comm);
+
+    auto window = comm.make_buffer<int>(size);
+    auto msg = comm.make_buffer<int>(size / 2);
+    for (auto& x : window) x = -1;
+    for (auto& x : msg) x = comm.rank();
+
+    auto local = comm.expose(window);
+    auto remote = comm.exchange(local, peer, 0);
+    EXPECT_EQ(remote.rank(), peer);
+    EXPECT_EQ(remote.size(), size * sizeof(int));
+
+    // put into the upper half, then notify
+    comm.put(msg, remote, size / 2).wait();
+    comm.flush(remote);
+    auto notify = comm.make_buffer<int>(1);
+    auto r_req = comm.recv(notify, peer, 1);
+    comm.send(notify, peer, 1).wait();
+    r_req.wait();
+
+    for (std::size_t i = 0; i < size / 2; ++i) EXPECT_EQ(window[i], -1);
+    for (std::size_t i = size / 2; i < size; ++i) EXPECT_EQ(window[i], peer);
+
+    // wait for all peers before the window goes out of scope
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+TEST_F(mpi_test_fixture, rma_get)
+{
+    using namespace oomph;
+    auto ctxt = oomph::test::make_context({{"OOMPH_MPI_RMA", "1"}});
+    if (!rma_supported(ctxt)) GTEST_SKIP();
+    auto comm = ctxt.get_communicator();
+    // the window may not be available on a single rank, see rma_single_rank
+    if (comm.size() == 1) GTEST_SKIP();
+
+    auto const peer = partner(comm);
+
+    auto window = comm.make_buffer<int>(size);
+    auto msg = comm.make_buffer<int>(size);
+    for (std::size_t i = 0; i < size; ++i) window[i] = comm.rank() * size + i;
+    for (auto& x : msg) x = -1;
+
+    auto local = comm.expose(window);
+    auto remote = comm.exchange(local, peer, 0);
+
+    comm.get(msg, remote).wait();
+    for (std::size_t i = 0; i < size; ++i) EXPECT_EQ(msg[i], (int)(peer * size + i));
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+// Some MPI implementations cannot create the window on a single rank: the context must work
+// regardless, and RMA reports the error when it is used
+TEST_F(mpi_test_fixture, rma_single_rank)
+{
+    using namespace oomph;
+    auto ctxt = [] {
+        oomph::test::scoped_env env({{"OOMPH_MPI_RMA", "1"}});
+        return context(MPI_COMM_SELF, false);
+    }();
+    if (!rma_supported(ctxt)) GTEST_SKIP();
+    auto comm = ctxt.get_communicator();
+
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg = comm.make_buffer<int>(size);
+    for (auto& x : smsg) x = 42;
+    auto r_req = comm.recv(rmsg, 0, 0);
+    comm.send(smsg, 0, 0).wait();
+    r_req.wait();
+    for (auto x : rmsg) EXPECT_EQ(x, 42);
+
+    auto window = comm.make_buffer<int>(size);
+    try
+    {
+        auto local = comm.expose(window);
+    }
+    catch (std::runtime_error const&)
+    {
+    }
+}
+
+// the MPI window is only created on demand
+TEST_F(mpi_test_fixture, rma_disabled)
+{
+    using namespace oomph;
+    auto ctxt = oomph::test::make_context({{"OOMPH_MPI_RMA", "0"}});
+    if (std::string(ctxt.get_transport_option("name")) != "mpi") GTEST_SKIP();
+    auto comm = ctxt.get_communicator();
+    auto window = comm.make_buffer<int>(size);
+    EXPECT_THROW(comm.expose(window), std::runtime_error);
+}
@@ -0,0 +1,289 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// messages to self: these hold whether or not the loopback queue is enabled (OOMPH_LOOPBACK=0)
+
+const std::size_t size = 1024;
+
+void
+fill(oomph::message_buffer<int>& msg, int value)
+{
+    for (auto& x : msg) x = value;
+}
+
+void
+check(oomph::message_buffer<int> const& msg, int value)
+{
+    for (auto x : msg) EXPECT_EQ(x, value);
+}
+
+TEST_F(mpi_test_fixture, self_recv_first)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg = comm.make_buffer<int>(size);
+    fill(smsg, 1);
+    fill(rmsg, 0);
+
+    auto r = comm.recv(rmsg, comm.rank(), 1);
+    auto s = comm.send(smsg, comm.rank(), 1);
+    s.wait();
+    r.wait();
+    check(rmsg, 1);
+}
+
+TEST_F(mpi_test_fixture, self_send_first)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+
+    // messages with the same tag are received in order, tags are matched independently
+    std::vector<message_buffer<int>> smsgs;
+    std::vector<send_request>        sreqs;
+    for (int i = 0; i < 4; ++i)
+    {
+        smsgs.push_back(comm.make_buffer<int>(size));
+        fill(smsgs.back(), i);
+        sreqs.push_back(comm.send(smsgs.back(), comm.rank(), i % 2));
+    }
+    auto rmsg = comm.make_buffer<int>(size);
+    for (int i : {1, 3, 0, 2})
+    {
+        comm.recv(rmsg, comm.rank(), i % 2).wait();
+        check(rmsg, i);
+    }
+    for (auto& s : sreqs) s.wait();
+}
+
+TEST_F(mpi_test_fixture, self_callbacks)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg = comm.make_buffer<int>(size);
+    fill(smsg, 2);
+
+    int sent = 0;
+    int received = 0;
+    comm.recv(std::move(rmsg), comm.rank(), 3,
+        [&](message_buffer<int> m, rank_type src, tag_type tag)
+        {
+            EXPECT_EQ(src, comm.rank());
+            EXPECT_EQ(tag, 3);
+            check(m, 2);
+            rmsg = std::move(m);
+            ++received;
+        });
+    comm.send(smsg, comm.rank(), 3, [&](message_buffer<int>&, rank_type, tag_type) { ++sent; });
+    while (sent < 1 || received < 1) comm.progress();
+    EXPECT_EQ(sent, 1);
+    EXPECT_EQ(received, 1);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, self_cancel)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg = comm.make_buffer<int>(size);
+    fill(smsg, 4);
+    fill(rmsg, 0);
+
+    auto r = comm.recv(rmsg, comm.rank(), 5);
+    EXPECT_TRUE(r.cancel());
+    EXPECT_EQ(comm.scheduled_recvs(), 0u);
+
+    // the message goes to the next receive
+    auto s = comm.send(smsg, comm.rank(), 5);
+    comm.recv(rmsg, comm.rank(), 5).wait();
+    s.wait();
+    check(rmsg, 4);
+}
+
+TEST_F(mpi_test_fixture, self_communicators)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm_0 = ctxt.get_communicator();
+    auto comm_1 = ctxt.get_communicator();
+    auto smsg = comm_0.make_buffer<int>(size);
+    auto rmsg = comm_1.make_buffer<int>(size);
+    fill(smsg, 6);
+
+    auto r = comm_1.recv(rmsg, comm_1.rank(), 7);
+    auto s = comm_0.send(smsg, comm_0.rank(), 7);
+    while (!(r.test() && s.test())) {}
+    check(rmsg, 6);
+}
+
+TEST_F(mpi_test_fixture, self_shared_recv)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg = comm.make_buffer<int>(size);
+    fill(smsg, 8);
+
+    auto r = comm.shared_recv(rmsg, comm.rank(), 9);
+    auto s = comm.send(smsg, comm.rank(), 9);
+    s.wait();
+    r.wait();
+    check(rmsg, 8);
+}
+
+TEST_F(mpi_test_fixture, self_large)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(1024 * size);
+    auto rmsg = comm.make_buffer<int>(1024 * size);
+    fill(smsg, 10);
+
+    auto s = comm.send(smsg, comm.rank(), 11);
+    auto r = comm.recv(rmsg, comm.rank(), 11);
+    while (!(r.test() && s.test())) {}
+    check(rmsg, 10);
+}
+
+// a message which does not fit into its receive throws instead of overrunning the buffer
+TEST_F(mpi_test_fixture, self_truncated)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto const loopback = std::getenv("OOMPH_LOOPBACK");
+    if (loopback && std::string(loopback) == "0") GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(2 * size);
+    auto rmsg = comm.make_buffer<int>(size);
+    fill(smsg, 12);
+
+    // receive first: the send throws, and the receive is still posted
+    auto r = comm.recv(rmsg, comm.rank(), 13);
+    EXPECT_THROW(comm.send(smsg, comm.rank(), 13), std::runtime_error);
+    EXPECT_TRUE(r.cancel());
+
+    // send first: the receive throws, and the message is still buffered
+    auto s = comm.send(smsg, comm.rank(), 14);
+    EXPECT_THROW(comm.recv(rmsg, comm.rank(), 14), std::runtime_error);
+    EXPECT_THROW(comm.shared_recv(rmsg, communicator::any_source, 14), std::runtime_error);
+    auto large = comm.make_buffer<int>(2 * size);
+    comm.recv(large, comm.rank(), 14).wait();
+    s.wait();
+    for (auto x : large) EXPECT_EQ(x, 12);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+TEST_F(mpi_test_fixture, self_any_source)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg = comm.make_buffer<int>(size);
+
+    // receive posted first
+    fill(smsg, 12);
+    fill(rmsg, 0);
+    rank_type src = -1;
+    auto r = comm.recv(rmsg, communicator::any_source, 13,
+        [&src](message_buffer<int>&, rank_type s, tag_type) { src = s; });
+    auto s = comm.send(smsg, comm.rank(), 13);
+    while (!(r.test() && s.test())) {}
+    EXPECT_EQ(src, comm.rank());
+    check(rmsg, 12);
+
+    // message sent first, received with any tag
+    fill(smsg, 14);
+    s = comm.send(smsg, comm.rank(), 15);
+    tag_type tag = -1;
+    r = comm.recv(rmsg, communicator::any_source, communicator::any_tag,
+        [&src, &tag](message_buffer<int>&, rank_type s, tag_type t)
+        {
+            src = s;
+            tag = t;
+        });
+    while (!(r.test() && s.test())) {}
+    EXPECT_EQ(src, comm.rank());
+    EXPECT_EQ(tag, 15);
+    check(rmsg, 14);
+
+    // a pending receive can be canceled
+    r = comm.recv(rmsg, communicator::any_source, 17);
+    comm.progress();
+    EXPECT_TRUE(r.cancel());
+    EXPECT_EQ(comm.scheduled_recvs(), 0u);
+}
+
+TEST_F(mpi_test_fixture, self_any_source_shared_recv)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg = comm.make_buffer<int>(size);
+    fill(smsg, 18);
+    fill(rmsg, 0);
+
+    auto r = comm.shared_recv(rmsg, communicator::any_source, 19);
+    auto s = comm.send(smsg, comm.rank(), 19);
+    s.wait();
+    r.wait();
+    check(rmsg, 18);
+}
+
+TEST_F(mpi_test_fixture, self_any_source_any_size)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    // the libfabric backend cannot probe for messages from other ranks
+    auto const name = std::string(ctxt.get_transport_option("name"));
+    if (name != "mpi" && name != "ucx") GTEST_SKIP();
+    auto comm = ctxt.get_communicator();
+    auto smsg = comm.make_buffer<int>(size);
+    fill(smsg, 20);
+
+    std::size_t received = 0u;
+    auto r = comm.recv_any_size<int>(communicator::any_source, 21,
+        [&](message_buffer<int> msg, rank_type src, tag_type)
+        {
+            EXPECT_EQ(src, comm.rank());
+            check(msg, 20);
+            received = msg.size();
+        });
+    auto s = comm.send(smsg, comm.rank(), 21);
+    while (!(r.test() && s.test())) {}
+    EXPECT_EQ(received, size);
+}
@@ -14,6 +14,12 @@
 #include <array>
 #include <iomanip>
 #include <thread>
+#include <type_traits>
+
+// the requests of the multi operations share their implementation but are distinct types
+static_assert(!std::is_same_v<oomph::send_multi_request, oomph::recv_multi_request>);
+static_assert(!std::is_same_v<oomph::send_multi_request, oomph::allreduce_request>);
+static_assert(!std::is_convertible_v<oomph::send_multi_request, oomph::recv_multi_request>);
 
 const int SIZE = 1000000;
 
@@ -166,3 +172,74 @@ TEST_F(mpi_test_fixture, send_multi_cb_wait)
         EXPECT_TRUE(check_msg(msg));
     }
 }
+
+TEST_F(mpi_test_fixture, recv_multi)
+{
+    using namespace oomph;
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto msg = comm.make_buffer<int>(SIZE);
+
+    if (comm.size() < 2) return;
+
+    if (comm.rank() == 0)
+    {
+        std::vector<message_buffer<int>> msgs;
+        std::vector<int>                 srcs;
+        std::vector<int>                 tags;
+        for (int i = 1; i < comm.size(); ++i)
+        {
+            msgs.push_back(comm.make_buffer<int>(SIZE));
+            reset_msg(msgs.back());
+            srcs.push_back(i);
+            tags.push_back(i);
+        }
+        comm.recv_multi(msgs, srcs, tags).wait();
+        for (auto const& m : msgs) EXPECT_TRUE(check_msg(m));
+    }
+    else
+    {
+        init_msg(msg);
+        comm.send(msg, 0, comm.rank()).wait();
+    }
+}
+
+TEST_F(mpi_test_fixture, recv_multi_cb)
+{
+    using namespace oomph;
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    auto comm = ctxt.get_communicator();
+    auto msg = comm.make_buffer<int>(SIZE);
+
+    if (comm.size() < 2) return;
+
+    if (comm.rank() == 0)
+    {
+        std::vector<message_buffer<int>> msgs;
+        std::vector<int>                 srcs;
+        std::vector<int>                 tags;
+        for (int i = 1; i < comm.size(); ++i)
+        {
+            msgs.push_back(comm.make_buffer<int>(SIZE));
+            reset_msg(msgs.back());
+            srcs.push_back(i);
+            tags.push_back(i);
+        }
+        std::vector<int> arrived(comm.size(), 0);
+        auto             req = comm.recv_multi(msgs, srcs, tags,
+                        [&arrived](message_buffer<int>& m, int src, int tag)
+                        {
+                            EXPECT_EQ(src, tag);
+                            EXPECT_TRUE(check_msg(m));
+                            ++arrived[src];
+                        });
+        req.wait();
+        EXPECT_TRUE(req.is_ready());
+        for (int i = 1; i < comm.size(); ++i) EXPECT_EQ(arrived[i], 1);
+    }
+    else
+    {
+        init_msg(msg);
+        comm.send(msg, 0, comm.rank()).wait();
+    }
+}
@@ -0,0 +1,193 @@
+/*
+ * ghex-org
+ *
+ * Copyright (c) 2014-2026, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <oomph/context.hpp>
+#include <gtest/gtest.h>
+#include "./mpi_runner/mpi_test_fixture.hpp"
+#include "./nccl_test_helpers.hpp"
+#include "./env_test_helpers.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+const std::size_t size = 1024;
+const int         num_ranges = 4;
+
+TEST_F(mpi_test_fixture, tag_range_factory)
+{
+    using namespace oomph;
+    util::tag_range_factory f0(0, 31);
+    EXPECT_EQ(f0.create(0).offset(), 0);
+    EXPECT_THROW(f0.create(1), std::out_of_range);
+
+    util::tag_range_factory f(3, 15);
+    EXPECT_EQ(f.num_ranges(), 3u);
+    EXPECT_EQ(f.create(0).max_tag(), (1 << 13) - 1);
+    EXPECT_EQ(f.create(2).offset(), 2 << 13);
+    EXPECT_EQ(f.create(1).map(5), (1 << 13) + 5);
+    EXPECT_NO_THROW(f.create(1).check((1 << 13) - 1, false));
+    EXPECT_NO_THROW(f.create(1).check(-1, true));
+    EXPECT_THROW(f.create(1).check(1 << 13, false), std::runtime_error);
+    EXPECT_THROW(f.create(1).check(-1, false), std::runtime_error);
+    EXPECT_THROW(f.create(1).check(-2, true), std::runtime_error);
+    EXPECT_THROW(f.create(3), std::out_of_range);
+    EXPECT_THROW(util::tag_range_factory(1 << 16, 15), std::runtime_error);
+}
+
+TEST_F(mpi_test_fixture, tag_range_disjoint)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false, 2);
+    EXPECT_EQ(ctxt.num_tag_ranges(), 2u);
+    auto comm_0 = ctxt.get_communicator(0);
+    auto comm_1 = ctxt.get_communicator(1);
+    EXPECT_EQ(comm_0.max_tag(), comm_1.max_tag());
+
+    auto const dst = (comm_0.rank() + 1) % comm_0.size();
+    auto const src = (comm_0.rank() + comm_0.size() - 1) % comm_0.size();
+
+    auto smsg_0 = comm_0.make_buffer<int>(size);
+    auto smsg_1 = comm_1.make_buffer<int>(size);
+    auto rmsg_0 = comm_0.make_buffer<int>(size);
+    auto rmsg_1 = comm_1.make_buffer<int>(size);
+    for (auto& x : smsg_0) x = 0;
+    for (auto& x : smsg_1) x = 1;
+
+    // same user tag on both communicators: messages must not cross ranges
+    auto r_1 = comm_1.recv(rmsg_1, src, 42);
+    auto r_0 = comm_0.recv(rmsg_0, src, 42);
+    auto s_0 = comm_0.send(smsg_0, dst, 42);
+    auto s_1 = comm_1.send(smsg_1, dst, 42);
+    while (!(r_0.test() && r_1.test() && s_0.test() && s_1.test())) {}
+
+    for (auto x : rmsg_0) EXPECT_EQ(x, 0);
+    for (auto x : rmsg_1) EXPECT_EQ(x, 1);
+}
+
+TEST_F(mpi_test_fixture, tag_range_threads)
+{
+    using namespace oomph;
+    try
+    {
+        auto ctxt = context(MPI_COMM_WORLD, true, num_ranges);
+
+        auto func = [&ctxt](int tid)
+        {
+            // every thread uses the same tags on its own range
+            auto       comm = ctxt.get_communicator(tid);
+            auto const dst = (comm.rank() + 1) % comm.size();
+            auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+            auto       smsg = comm.make_buffer<int>(size);
+            auto       rmsg = comm.make_buffer<int>(size);
+            for (int i = 0; i < 10; ++i)
+            {
+                for (auto& x : smsg) x = tid * 100 + i;
+                auto r = comm.recv(rmsg, src, i);
+                comm.send(smsg, dst, i).wait();
+                r.wait();
+                for (auto x : rmsg) EXPECT_EQ(x, tid * 100 + i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_ranges);
+        for (int i = 0; i < num_ranges; ++i) threads.push_back(std::thread{func, i});
+        for (auto& t : threads) t.join();
+    }
+    catch (std::runtime_error const& e)
+    {
+        oomph::test::handle_nccl_thread_safe_exception(e);
+    }
+}
+
+TEST_F(mpi_test_fixture, tag_range_max_tag)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = context(MPI_COMM_WORLD, false);
+    if (std::string(ctxt.get_transport_option("name")) == "libfabric")
+    {
+        // the user tag is no longer truncated to 24 bits
+        auto const layout = std::string(ctxt.get_transport_option("tag_layout"));
+        EXPECT_NE(layout.find("tag:"), std::string::npos);
+        // receives match the sender through the rank field of the tag
+        if (world_size > 1) EXPECT_EQ(layout.find("rank:0,"), std::string::npos);
+    }
+    auto       comm = ctxt.get_communicator();
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto const src = (comm.rank() + comm.size() - 1) % comm.size();
+
+    // the largest and smallest tags reach the receiver intact
+    auto smsg = comm.make_buffer<int>(size);
+    auto rmsg_0 = comm.make_buffer<int>(size);
+    auto rmsg_1 = comm.make_buffer<int>(size);
+    for (auto& x : smsg) x = comm.rank();
+    auto r_1 = comm.recv(rmsg_1, src, comm.max_tag());
+    auto r_0 = comm.recv(rmsg_0, src, 0);
+    comm.send(smsg, dst, comm.max_tag()).wait();
+    comm.send(smsg, dst, 0).wait();
+    r_0.wait();
+    r_1.wait();
+    for (auto x : rmsg_0) EXPECT_EQ(x, src);
+    for (auto x : rmsg_1) EXPECT_EQ(x, src);
+}
+
+// tags outside of [0, max_tag] are rejected instead of leaking into other tag ranges
+TEST_F(mpi_test_fixture, tag_range_out_of_range)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto       ctxt = context(MPI_COMM_WORLD, false, 2);
+    auto       comm = ctxt.get_communicator(0);
+    auto const dst = (comm.rank() + 1) % comm.size();
+    auto       msg = comm.make_buffer<int>(size);
+
+    EXPECT_THROW(comm.send(msg, dst, comm.max_tag() + 1), std::runtime_error);
+    EXPECT_THROW(comm.send(msg, dst, -2), std::runtime_error);
+    EXPECT_THROW(comm.send(msg, dst, communicator::any_tag), std::runtime_error);
+    EXPECT_THROW(comm.recv(msg, dst, comm.max_tag() + 1), std::runtime_error);
+    EXPECT_THROW(comm.recv(msg, dst, -2), std::runtime_error);
+    EXPECT_THROW(comm.shared_recv(msg, dst, comm.max_tag() + 1), std::runtime_error);
+    EXPECT_THROW(comm.recv_any_size<int>(dst, -2, [](message_buffer<int>, rank_type, tag_type) {}),
+        std::runtime_error);
+    EXPECT_TRUE(comm.is_ready());
+}
+
+// receives with any_tag only match the messages of their tag range (the MPI backend needs a
+// matching communicator per tag range for this)
+TEST_F(mpi_test_fixture, tag_range_any_tag)
+{
+    using namespace oomph;
+    if (oomph::test::is_nccl_backend()) GTEST_SKIP();
+    auto ctxt = [] {
+        oomph::test::scoped_env env({{"OOMPH_MPI_COMM_POOL_SIZE", "2"}});
+        return context(MPI_COMM_WORLD, false, 2);
+    }();
+
+    auto       comm_0 = ctxt.get_communicator(0);
+    auto       comm_1 = ctxt.get_communicator(1);
+    auto const dst = (comm_0.rank() + 1) % comm_0.size();
+    auto const src = (comm_0.rank() + comm_0.size() - 1) % comm_0.size();
+
+    auto smsg_0 = comm_0.make_buffer<int>(size);
+    auto smsg_1 = comm_1.make_buffer<int>(size);
+    auto rmsg_0 = comm_0.make_buffer<int>(size);
+    auto rmsg_1 = comm_1.make_buffer<int>(size);
+    for (auto& x : smsg_0) x = 0;
+    for (auto& x : smsg_1) x = 1;
+
+    auto r_1 = comm_1.recv(rmsg_1, src, communicator::any_tag);
+    auto r_0 = comm_0.recv(rmsg_0, src, 7);
+    auto s_0 = comm_0.send(smsg_0, dst, 7);
+    auto s_1 = comm_1.send(smsg_1, dst, 8);
+    while (!r_0.test() || !r_1.test() || !s_0.test() || !s_1.test()) {}
+    for (auto x : rmsg_0) EXPECT_EQ(x, 0);
+    for (auto x : rmsg_1) EXPECT_EQ(x, 1);
+}